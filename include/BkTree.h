@@ -0,0 +1,53 @@
+#ifndef BKTREE_H
+#define BKTREE_H
+#include <string_view>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Burkhard-Keller tree over Damerau-Levenshtein distance. Each child hangs off
+// its parent by its distance to it, so by the triangle inequality a search of
+// radius k at distance d only needs the children at d - k ... d + k.
+// The tree is built once, then laid out breadth first in one array with
+// siblings contiguous and sorted by that distance, so picking the children to
+// visit is a binary search over neighbouring nodes.
+// Matches are rescored with editDistance (OSA), which is what correct() ranks by.
+class BkTree
+{
+public:
+	BkTree();
+	~BkTree() = default;
+
+	// build (replaces whatever was indexed before)
+	void build(const std::vector<std::string> &words);
+	bool loadFile(const std::string &filename); // word list, one per line
+	void clear();
+
+	// words within maxDistance edits of word, paired with their distance
+	void lookup(std::string_view word, int maxDistance, std::vector<std::pair<std::string, int>> &out) const;
+	bool isEmpty() const;
+	std::size_t size() const;
+
+	void memoryReport(std::ostream &out) const;
+
+private:
+	struct BkNode {
+		std::uint32_t m_word {0}; // index into m_offsets
+		std::uint32_t m_children {0}; // first child in m_nodes
+		std::uint16_t m_childCount {0};
+		std::uint8_t m_distance {0}; // distance to the parent
+		std::uint8_t m_maxChild {0}; // largest m_distance among the children
+	};
+
+	std::string m_text; // every word back to back
+	std::vector<std::uint32_t> m_offsets; // word i = m_text[m_offsets[i], m_offsets[i + 1])
+	std::vector<BkNode> m_nodes; // m_nodes[0] is the root
+
+    /*********************************
+    // Helper declarations go here
+    **********************************/
+	
+	std::string_view wordAt(std::uint32_t index) const;
+};
+#endif
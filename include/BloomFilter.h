@@ -0,0 +1,56 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+#include <string_view>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Utils.h"
+
+// Blocked Bloom filter over the dictionary, for rejecting misspelled words
+// before anything walks the trie. A word hashes to one 64-byte block (one
+// cache line) and sets one bit in each of its eight 64-bit lanes, so a probe
+// is a single line load and eight bit tests. No false negatives: a word the
+// filter rejects is not in the word list it was built from.
+// Words are hashed the way the trie reads them (case folded, non-letters
+// skipped), so raw tokens can be probed without normalizing them first.
+class BloomFilter
+{
+public:
+	explicit BloomFilter(std::size_t bitsPerWord = dct::g_bloomBits);
+	~BloomFilter() = default;
+
+	// build (replaces whatever was indexed before)
+	void build(const std::vector<std::string> &words);
+	void clear();
+
+	// false only if word is certainly not in the list
+	bool mayContain(std::string_view word) const;
+	bool isEmpty() const;
+	std::size_t size() const;
+	std::size_t memory() const; // bytes
+	double expectedFalsePositiveRate() const; // for a random absent word, from how full the blocks are
+
+	void memoryReport(std::ostream &out) const;
+
+private:
+	static constexpr int m_lanes {8};
+
+	struct alignas(64) Block
+	{
+		std::uint64_t m_bits[m_lanes];
+	};
+
+	std::size_t m_bitsPerWord;
+	std::size_t m_count {0};
+	std::vector<Block> m_blocks;
+
+    /*********************************
+    // Helper declarations go here
+    **********************************/
+
+	std::size_t blockIndex(std::uint64_t hash) const;
+	static std::uint64_t hash(std::string_view word);
+	static std::uint64_t laneBit(std::uint64_t hash, int lane);
+};
+#endif
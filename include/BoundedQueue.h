@@ -0,0 +1,55 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <cstddef>
+
+// Blocking FIFO with a fixed capacity, connects the stages of a pipeline.
+// close() wakes everyone: pushes fail from then on, pops drain what is left.
+template <typename T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue(std::size_t capacity) : m_capacity{capacity ? capacity : 1} {}
+
+	bool push(T item)
+	{
+		std::unique_lock<std::mutex> lock {m_mutex};
+		m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+		if (m_closed) return false;
+
+		m_items.push_back(std::move(item));
+		m_notEmpty.notify_one();
+		return true;
+	}
+
+	bool pop(T &item)
+	{
+		std::unique_lock<std::mutex> lock {m_mutex};
+		m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+		if (m_items.empty()) return false; // closed and drained
+
+		item = std::move(m_items.front());
+		m_items.pop_front();
+		m_notFull.notify_one();
+		return true;
+	}
+
+	void close()
+	{
+		std::lock_guard<std::mutex> lock {m_mutex};
+		m_closed = true;
+		m_notFull.notify_all();
+		m_notEmpty.notify_all();
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_notFull;
+	std::condition_variable m_notEmpty;
+	std::deque<T> m_items;
+	std::size_t m_capacity;
+	bool m_closed {false};
+};
+#endif
@@ -0,0 +1,131 @@
+#ifndef CONCURRENTTRIE_H
+#define CONCURRENTTRIE_H
+#include "Trie.h"
+#include <string_view>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+// Trie for live updates: any number of readers run alongside writers without
+// taking a lock. Nodes never change once published. A write copies the nodes
+// on the path it changes (path copying), links the copies to the untouched
+// subtrees and publishes the new root with one atomic store, so a reader sees
+// the trie from before or after a write, never part of one.
+// Writers take turns on a mutex. Nodes a write replaced are retired, and freed
+// once every reader that could still be holding them has finished: readers
+// announce the epoch they started in, every write moves the epoch on, and a
+// node retired in epoch r is safe once no reader is still in an epoch <= r
+// (epoch-based reclamation).
+class ConcurrentTrie
+{
+public:
+	struct Stats
+	{
+		std::size_t m_words {0};
+		std::uint64_t m_epoch {0};
+		std::size_t m_writes {0};
+		std::size_t m_copied {0}; // nodes created, by builds and path copying
+		std::size_t m_retired {0}; // replaced, waiting on readers
+		std::size_t m_reclaimed {0}; // replaced and freed
+		std::size_t m_readers {0}; // reads in progress when sampled
+	};
+
+	ConcurrentTrie();
+	~ConcurrentTrie(); // no reads or writes may still be running
+	ConcurrentTrie(const ConcurrentTrie &) = delete;
+	ConcurrentTrie &operator=(const ConcurrentTrie &) = delete;
+
+	// replaces the contents (entries sorted, as collectEntries gives them); readers keep working throughout
+	void build(const std::vector<Trie::WordEntry> &entries);
+
+	// writes expect a normalized word, like Trie
+	bool insert(std::string_view word, int word_id, std::uint32_t score = 0);
+	bool insertForm(std::string_view form, int lemma_id, std::uint32_t score = 0); // see Trie::insertForm
+	bool remove(std::string_view word);
+
+	// reads fold case and skip non-letters as they descend, like Trie
+	bool contains(std::string_view word) const;
+	int findID(std::string_view word) const; // the lemma's word_id, for a lemma or any of its forms; -1 if absent
+	void collectWithPrefix(std::string_view prefix, std::vector<std::string> &out, std::size_t limit, bool withPrefix = true) const;
+	void collectEntries(std::vector<Trie::WordEntry> &out) const;
+	bool isEmpty() const;
+	std::size_t size() const;
+
+	Stats stats() const;
+	void memoryReport(std::ostream &out) const;
+
+private:
+	// immutable once published; the children (only those that exist, by letter) follow the node in the same allocation
+	struct alignas(8) Node
+	{
+		std::uint32_t m_childMask {0};
+		int m_wordID {-1};
+		std::uint32_t m_score {0};
+		std::uint32_t m_maxScore {0}; // best m_score in this subtree
+		bool m_isEndOfWord {false};
+		bool m_isForm {false};
+
+		int childCount() const { return __builtin_popcount(m_childMask); }
+		int slot(int index) const { return __builtin_popcount(m_childMask & ((1u << index) - 1)); }
+		const Node *const *children() const { return reinterpret_cast<const Node *const *>(this + 1); }
+		const Node **children() { return reinterpret_cast<const Node **>(this + 1); }
+	};
+
+	// one per concurrent reader, on its own cache line: the epoch it started in, 0 when free
+	struct alignas(64) ReaderSlot
+	{
+		std::atomic<std::uint64_t> m_epoch {0};
+	};
+	static constexpr std::size_t m_readerSlots {256};
+
+	// a read in progress: holds a reader slot, so nothing it can reach is freed under it
+	class ReadGuard
+	{
+	public:
+		explicit ReadGuard(const ConcurrentTrie &trie);
+		~ReadGuard();
+		ReadGuard(const ReadGuard &) = delete;
+		ReadGuard &operator=(const ReadGuard &) = delete;
+
+		const Node *root() const { return m_root; }
+
+	private:
+		const ConcurrentTrie &m_trie;
+		std::size_t m_slot;
+		const Node *m_root;
+	};
+
+	std::atomic<const Node *> m_root;
+	mutable ReaderSlot m_readers[m_readerSlots];
+	std::atomic<std::uint64_t> m_epoch {1};
+
+	// writer side, under m_writeMutex
+	mutable std::mutex m_writeMutex; // also taken by the const stats and memoryReport
+	std::vector<std::pair<std::uint64_t, const Node *>> m_retired; // (epoch retired in, node), oldest first
+	std::atomic<std::size_t> m_count {0};
+	std::size_t m_writes {0};
+	std::size_t m_copied {0};
+	std::size_t m_reclaimed {0};
+	std::size_t m_nodeBytes {0}; // live nodes, published or waiting to be freed
+
+    /*********************************
+    // Helper declarations go here
+    **********************************/
+
+	static const Node *child(const Node *node, int index);
+	Node *makeNode(const Node *from, int childCount); // copy of from's fields (or a blank node) with room for childCount children
+	bool insert(std::string_view word, int word_id, std::uint32_t score, bool isForm);
+	static std::size_t nodeBytes(int childCount);
+	void freeNode(const Node *node);
+	const Node *withChild(const Node *old, int index, const Node *replacement); // copy of old with one child swapped, added or (nullptr) dropped
+	static std::uint32_t maxScore(const Node *node);
+	const Node *buildRange(const std::vector<Trie::WordEntry> &entries, std::size_t first, std::size_t last, std::size_t depth);
+	void publish(const Node *root, std::vector<const Node *> &replaced);
+	void reclaim();
+	void collectSubtree(const Node *node, std::vector<const Node *> &out) const;
+	void collectEntries(const Node *node, std::string &currentWord, std::vector<Trie::WordEntry> &out) const;
+};
+#endif
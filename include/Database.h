@@ -4,37 +4,91 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <unordered_map>
+#include <string_view>
+#include "WordInfo.h"
 
 
 // This class acts as a wrapper around a C library
 class Database
 {
 public:
+	// RAII handle to a cached prepared statement, reset and unbound (not finalized)
+	// when it goes out of scope so the next call can rebind it
+	class Statement
+	{
+	public:
+		explicit Statement(sqlite3_stmt *stmt) : m_stmt{stmt} {}
+		~Statement();
+		Statement(Statement &&other) noexcept : m_stmt{other.m_stmt} { other.m_stmt = nullptr; }
+		Statement(const Statement &) = delete;
+		Statement &operator=(const Statement &) = delete;
+		Statement &operator=(Statement &&) = delete;
+
+		sqlite3_stmt *get() const { return m_stmt; }
+		explicit operator bool() const { return m_stmt != nullptr; }
+
+	private:
+		sqlite3_stmt *m_stmt;
+	};
+
 	Database(const std::string &filename);
 	~Database();
+
+	Database(const Database &) = delete;
+	Database &operator=(const Database &) = delete;
 	
 	void createTables();
+	void createIndexes();
+	void dropIndexes();
+
+	// bulk import: WAL + relaxed syncing, indexes dropped until the end, caller batches transactions
+	void beginBulkImport();
+	void endBulkImport();
+	bool beginTransaction();
+	bool commit();
 
 	// inserters
 	bool insertWord(const std::string &lemma);
 	bool insertEtymology(int word_id, const std::vector<std::string> &etymology);
 	bool insertForm(int word_id, const std::string &form, const std::string &tag);
-	bool insertSense(int word_id, const std::string &pos, const std::string &definition);
-	bool insertExample(int word_id, const std::string &example);
-	bool insertSynonym(int word_id, const std::string &synonym);
-	bool insertAntonym(int word_id, const std::string &antonym);
+	int insertSense(int word_id, const std::string &pos, const std::string &definition); // the new sense's id, -1 on failure
+	// examples, synonyms and antonyms belong to one sense
+	bool insertExample(int sense_id, const std::string &example);
+	bool insertSynonym(int sense_id, const std::string &synonym);
+	bool insertAntonym(int sense_id, const std::string &antonym);
 
 	bool removeWord(int word_id); // implement
 	
 	// getters
 	sqlite3 *getDB();
 	int getWordID(const std::string &lemma);
+	int getLastWordID(); // highest word id, 0 when empty
+	long long getTotalChanges(); // rows inserted/updated/deleted since the connection opened
+
+	// everything stored about a word (lemma, etymology, forms, senses with their examples,
+	// synonyms and antonyms) in two queries, streamed into out, reusing whatever it already holds;
+	// false if there is no such word
+	bool fetchEntry(int word_id, WordInfo &out);
+
+	// compiled once per query text and kept until the database closes
+	// (only one handle per query may be live at a time)
+	Statement prepare(const char *sql);
 
 private:
 	sqlite3 *db;
 
-	/*********************************
+	std::unordered_map<std::string_view, sqlite3_stmt *> m_statements; // keys view the statement's own copy of its SQL
+	std::vector<int> m_senseIDs; // fetchEntry's, kept between calls
+
+	// connection settings to restore after a bulk import
+	std::string m_journalMode {"delete"};
+	int m_synchronous {2}; // FULL
+	bool m_bulk {false};
+
+    /*********************************
     // Helper declarations go here
     **********************************/
+	bool exec(const char *sql);
 };
 #endif 
@@ -0,0 +1,79 @@
+#ifndef DAWG_H
+#define DAWG_H
+#include <string_view>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+// Read-only minimized directed acyclic word graph. Words are fed once in
+// sorted order and shared suffixes ("-ing", "-ness") are merged as the build
+// goes (incremental minimization), so the graph never holds the full trie.
+// Each node also counts the words below it, which numbers every accepted
+// word by its rank and maps it back to its word_id.
+class Dawg
+{
+public:
+	Dawg();
+	~Dawg() = default;
+
+	// build
+	bool insert(std::string_view word, int word_id); // words must arrive in sorted order
+	void finish(); // minimize what is left, the graph is read-only afterwards
+	bool loadFile(const std::string &filename); // sorted word list, one per line, ids are line numbers
+	void clear();
+
+	// queries (valid after finish)
+	bool contains(std::string_view word) const;
+	bool startsWith(std::string_view prefix) const;
+	bool isEmpty() const;
+	int getWordID(std::string_view word) const;
+	int wordIndex(std::string_view word) const; // perfect hash: rank of the word, -1 if absent
+	std::size_t size() const;
+
+	void collectWithPrefix(std::string_view prefix, std::vector<std::string> &out, std::size_t limit) const;
+	void memoryReport(std::ostream &out) const;
+
+private:
+	struct DawgNode {
+		std::uint32_t m_childMask {0}; // bit i set -> child for 'a' + i
+		std::uint32_t m_children {0}; // first slot in m_edges
+		std::uint32_t m_count {0}; // number of words accepted from this node
+		bool m_isEndOfWord {false};
+
+		bool hasChild(int index) const { return m_childMask & (1u << index); }
+		int childCount() const { return __builtin_popcount(m_childMask); }
+		int slot(int index) const { return __builtin_popcount(m_childMask & ((1u << index) - 1)); }
+	};
+
+	// node on the path of the last inserted word, not yet merged into the graph
+	struct OpenNode {
+		char m_letter {0}; // edge from the parent open node
+		bool m_isEndOfWord {false};
+		std::vector<std::pair<int, std::uint32_t>> m_children; // (letter index, frozen node)
+	};
+
+	static constexpr std::uint32_t m_nil {0}; // node 0 is a dead state, never a real child
+
+	std::vector<DawgNode> m_nodes;
+	std::vector<std::uint32_t> m_edges;
+	std::vector<int> m_wordIDs; // word_id by rank
+	std::uint32_t m_root {m_nil};
+
+	// build state
+	std::vector<OpenNode> m_path;
+	std::unordered_map<std::string, std::uint32_t> m_register; // node signature -> equivalent frozen node
+	std::string m_lastWord;
+	bool m_finished {false};
+
+	/*********************************
+    // Helper declarations go here
+    **********************************/
+	void minimize(std::size_t depth);
+	std::uint32_t freeze(const OpenNode &open);
+	std::uint32_t child(std::uint32_t node, int index) const;
+	std::uint32_t findNode(std::string_view word) const;
+	void collectFromNode(std::uint32_t node, std::string &currentWord, std::vector<std::string> &out, std::size_t limit) const;
+};
+#endif
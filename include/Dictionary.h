@@ -1,9 +1,18 @@
 #ifndef DICTIONARY_H
 #define DICTIONARY_H
 #include "Trie.h"
+#include "ConcurrentTrie.h"
 #include "Database.h"
+#include "Utils.h"
+#include "WordInfo.h"
+#include "WordCache.h"
+#include "ImportPipeline.h"
 #include "../nlohmann/json.hpp"
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
 
 class Tester;
 //class Trie;
@@ -19,57 +28,65 @@ public:
 
     bool addWord(std::string_view word);
     bool removeWord(std::string_view word); // implement databse logic
-	bool search(std::string_view word) const; 
+	bool search(std::string_view word) const; // lemmas and their forms
+	int lookup(std::string_view word) const; // word_id of the lemma word is or is a form of ("running" -> "run"), -1 if absent
+	// everything stored about the lemma of word, from the cache or else the database; nullptr if unknown
+	std::shared_ptr<const WordInfo> getInfo(std::string_view word);
+	const WordCache &cache() const;
 	bool isEmpty() const;
+	// moves on whenever words may have been added, so whatever was built from getWords can tell it is stale
+	std::uint64_t generation() const;
 
 	void suggestFromPrefix(std::string_view prefix, std::vector<std::string> &results, std::size_t limit) const;
+	void suggestCorrections(std::string_view word, std::vector<std::string> &results, std::size_t limit) const;
     void print() const; 
     void dump() const;
 	void dumpWord(std::string_view word) const;
     void eraseAll();
 	void loadInfo(const std::string &filename);
+	std::size_t loadFrequencies(const std::string &filename); // "word count" per line, returns the words scored
+  
+	std::string normalize(std::string_view word) const; 
   
 	// getters
-	
+	void getWords(std::vector<std::string> &out) const; // every word, alphabetical
+	Trie::Cursor getCursor() const; // keystroke walker, invalidated by addWord/removeWord
 
-private:
-	// represent word info from the db in memory
-	struct WordInfo
-	{
-       	std::string lemma; // word
-	    std::vector<std::string> etymology;
-	    int id{-1}; // ??
-        
-	    // plurals or alternative spellings
-	    struct Form
-        {
-	    	std::string form;
-	    	std::string tag;
-	    };
-	    std::vector<Form> forms; 
-        
-	    struct Sense
-	 	{
-	 	    std::string pos; // noun, verb, adj, etc.
-	 	    std::string definition;
-	 	    std::vector<std::string> examples;
-      	    std::vector<std::string> synonyms;
-     	    std::vector<std::string> antonyms;
-     	};
-	    std::vector<Sense> senses; // acts a 'cache'
-	};
+	// live mode: search and suggestFromPrefix stay lock-free while other threads call
+	// addWord/removeWord. Corrections, getWords, the cursor and the dumps keep reading
+	// the trie as it was when live mode started; turning it off brings them up to date.
+	// Switch modes while no other thread is using the dictionary.
+	void setConcurrent(bool live);
+	bool isConcurrent() const;
 
+	// rebuild the words (and forms) starting with letter from the database, leaving every other letter
+	// as it is (not in live mode); returns the words loaded
+	std::size_t reloadShard(char letter);
+
+private:
     Trie m_trie;
+	std::unique_ptr<ConcurrentTrie> m_live; // set in live mode, and then the one addWord/removeWord change
 	Database m_db;
+	std::mutex m_writeMutex; // one addWord/removeWord/database read at a time (the connection and its statements are not shared)
+	WordCache m_cache;
+	std::atomic<std::uint64_t> m_generation {0};
+	WordInfo m_fetched; // getInfo's (under m_writeMutex): fetchEntry writes over it in place, the cache gets a copy
 
     /*********************************
     // Helper declarations go here
     **********************************/
 	
-    bool loadjson(const std::string &filename); // make public for now (load into db)
+    bool loadjson(const std::string &filename, std::size_t batchSize = dct::g_importBatch, unsigned threads = dct::g_importThreads); // make public for now (load into db)
 	
+	void storeEntry(WordInfo &word);
+	bool addForm(std::string_view form, int lemma_id); // into the trie only
+	void removeForms(int lemma_id); // the lemma's forms out of the trie (under m_writeMutex)
 	void buildTrie(Database &db); // implement lemma logic
-
-	std::string normalize(std::string_view word) const; 
+	// (id, lemma) rows sorted by lemma: one trie per first letter, built on pool workers, then copied into m_trie
+	void buildShards(const std::vector<std::pair<int, std::string_view>> &rows, unsigned threads = dct::g_buildThreads);
+	static std::size_t loadForms(Database &db, Trie &trie, char letter = '\0'); // the forms table into trie (just forms under letter, if given)
+	bool loadImage();
+	bool saveImage();
+	std::uint64_t imageStamp();
 };
 #endif
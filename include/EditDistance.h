@@ -0,0 +1,55 @@
+#ifndef EDITDISTANCE_H
+#define EDITDISTANCE_H
+#include <string_view>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+namespace dct
+{
+	// restricted Damerau-Levenshtein (optimal string alignment): insert, delete,
+	// substitute and swap adjacent letters each cost 1. Every correction engine ranks with it.
+	int editDistance(std::string_view a, std::string_view b);
+
+	// same, but stops early and returns maxDistance + 1 once the distance has to exceed maxDistance
+	int editDistance(std::string_view a, std::string_view b, int maxDistance);
+
+	// true Damerau-Levenshtein: like editDistance, but a swapped pair may be edited again
+	// ("ca" -> "abc" is 2, not 3). Unlike OSA it is a metric, so metric trees can prune with it.
+	// It never exceeds editDistance, so anything within k by editDistance is within k here too.
+	int damerauLevenshtein(std::string_view a, std::string_view b);
+	int damerauLevenshtein(std::string_view a, std::string_view b, int maxDistance);
+
+	// a query prepared for the bit-parallel OSA kernel (Hyyro's extension of Myers' algorithm):
+	// one DP column is a bit vector over the query's letters, so comparing against a
+	// candidate costs a handful of word operations per candidate letter. Queries up to
+	// 64 letters run in one 64-bit word; longer ones fall back to editDistance.
+	class EditPattern
+	{
+	public:
+		explicit EditPattern(std::string_view word);
+
+		int distance(std::string_view candidate) const; // same value as editDistance(word, candidate)
+		int distance(std::string_view candidate, int maxDistance) const; // capped at maxDistance + 1
+
+		// out[i] = distance(candidates[i]). Queries up to 32 letters verify 8 candidates
+		// per step on AVX2 (4 on SSE2), chosen at runtime; otherwise one at a time
+		void distances(const std::string_view *candidates, std::size_t count, int *out) const;
+
+		std::size_t size() const;
+
+		static const char *batchKernel(); // "avx2", "sse2" or "scalar" on this machine
+
+	private:
+		std::string m_word;
+		std::array<std::uint64_t, 256> m_matches {}; // bit i set -> m_word[i] is that byte
+		std::array<std::uint32_t, 256> m_matches32 {}; // low 32 bits, for the batched lanes
+	};
+
+	// sort (word, distance) pairs closest first, alphabetical among equals, and keep the first limit words
+	void rankCandidates(std::vector<std::pair<std::string, int>> &candidates, std::vector<std::string> &results, std::size_t limit);
+}
+#endif
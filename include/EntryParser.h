@@ -0,0 +1,60 @@
+#ifndef ENTRYPARSER_H
+#define ENTRYPARSER_H
+#include "WordInfo.h"
+#include "../nlohmann/json.hpp"
+#include <string_view>
+
+// SAX parser for one Wiktextract JSONL line. It never builds a DOM: only the
+// fields WordInfo needs (word, pos, etymology_text, forms, senses) are copied,
+// straight into a WordInfo whose strings and vectors are recycled between lines.
+class EntryParser
+{
+public:
+	EntryParser() = default;
+
+	bool parse(std::string_view line); // false on malformed JSON or an entry without a word
+	bool failed() const { return m_failed; } // last parse was malformed, not just missing a word
+	WordInfo &entry() { return m_entry; }
+
+	// nlohmann::json_sax interface
+	bool null();
+	bool boolean(bool val);
+	bool number_integer(nlohmann::json::number_integer_t val);
+	bool number_unsigned(nlohmann::json::number_unsigned_t val);
+	bool number_float(nlohmann::json::number_float_t val, const std::string &s);
+	bool string(std::string &val);
+	bool binary(nlohmann::json::binary_t &val);
+	bool start_object(std::size_t elements);
+	bool end_object();
+	bool start_array(std::size_t elements);
+	bool end_array();
+	bool key(std::string &val);
+	bool parse_error(std::size_t position, const std::string &last_token, const nlohmann::json::exception &ex);
+
+private:
+	// where the parser currently is inside the entry
+	enum class Scope { Root, Entry, Forms, Form, Tags, Senses, Sense, Glosses, Examples, Example, Synonyms, Synonym, Antonyms, Antonym, Skip };
+	enum class Key { Other, Word, Pos, Etymology, Forms, Senses, Form, Tags, Glosses, Examples, Synonyms, Antonyms, Text };
+
+	WordInfo m_entry;
+	std::string m_etymology;
+	std::string m_entryPos; // top level pos, default for senses without their own
+	std::vector<Scope> m_scopes;
+	Key m_key {Key::Other};
+	bool m_hasWord {false};
+	bool m_failed {false};
+
+	// recycled storage so steady-state parsing doesn't allocate
+	std::vector<std::string> m_freeStrings;
+	std::vector<WordInfo::Form> m_freeForms;
+	std::vector<WordInfo::Sense> m_freeSenses;
+
+    /*********************************
+    // Helper declarations go here
+    **********************************/
+	void reset();
+	void recycle(std::vector<std::string> &list);
+	void append(std::vector<std::string> &list, std::string_view value);
+	void pushScope(Scope scope);
+};
+#endif
@@ -0,0 +1,48 @@
+#ifndef IMPORTPIPELINE_H
+#define IMPORTPIPELINE_H
+#include "WordInfo.h"
+#include "EntryParser.h"
+#include "Utils.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+
+// Parallel JSONL import: a reader thread slices the mapped file into batches of
+// lines, worker threads SAX-parse them, and the calling thread receives the
+// entries strictly in file order, so whatever it writes gets the same ids as a
+// sequential import.
+class ImportPipeline
+{
+public:
+	explicit ImportPipeline(unsigned threads = dct::g_importThreads); // 0 = one per core
+
+	bool run(const std::string &filename, const std::function<void(WordInfo &)> &sink);
+	std::size_t badLines() const { return m_badLines; }
+
+private:
+	struct Batch
+	{
+		std::size_t m_seq {0};
+		std::size_t m_firstLine {0}; // 1-based line number of m_lines[0]
+		std::vector<std::string_view> m_lines; // views into the mapped file
+	};
+
+	// reused once the sink is done with it: m_entries past m_count hold earlier entries' storage
+	struct Parsed
+	{
+		std::size_t m_seq {0};
+		std::vector<WordInfo> m_entries;
+		std::size_t m_count {0}; // entries parsed into this batch
+		std::vector<std::size_t> m_badLines;
+	};
+
+	unsigned m_threads;
+	std::size_t m_badLines {0};
+
+    /*********************************
+    // Helper declarations go here
+    **********************************/
+	void parseBatch(EntryParser &parser, const Batch &batch, Parsed &out) const;
+};
+#endif
@@ -0,0 +1,32 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file (POSIX mmap). The pages are
+// shared with every other process mapping the same file.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+	MappedFile(MappedFile &&other) noexcept;
+	MappedFile &operator=(MappedFile &&other) noexcept;
+
+	bool open(const std::string &filename);
+	void close();
+
+	// getters
+	const char *data() const { return m_data; }
+	std::size_t size() const { return m_size; }
+	bool isOpen() const { return m_open; }
+
+private:
+	const char *m_data {nullptr};
+	std::size_t m_size {0};
+	bool m_open {false};
+};
+#endif
@@ -0,0 +1,49 @@
+#ifndef NORMALIZE_H
+#define NORMALIZE_H
+#include <string_view>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace dct
+{
+	// 0-25 for 'a'-'z' or 'A'-'Z', -1 for anything normalization drops (digits, punctuation, non-ASCII)
+	inline int letterIndex(char c)
+	{
+		unsigned folded {static_cast<unsigned char>(c) | 0x20u};
+		return folded - 'a' < 26u ? static_cast<int>(folded - 'a') : -1;
+	}
+
+	inline bool hasLetter(std::string_view word)
+	{
+		for (char c : word) if (letterIndex(c) >= 0) return true;
+		return false;
+	}
+
+	// writes the letters of word, lowercased, to out (room for word.size() chars), returns how many
+	std::size_t normalizeInto(std::string_view word, char *out);
+
+	// normalizes many words back to back into one buffer, sized once for the batch;
+	// out[i] views the result for words[i] and stays valid until buffer changes
+	void normalizeBatch(const std::string_view *words, std::size_t count, std::string &buffer, std::vector<std::string_view> &out);
+
+	// normalized copy kept on the stack for ordinary words, on the heap only past m_inline letters
+	class NormalizedWord
+	{
+	public:
+		explicit NormalizedWord(std::string_view word);
+		NormalizedWord(const NormalizedWord &) = delete; // the view may point into m_small
+		NormalizedWord &operator=(const NormalizedWord &) = delete;
+
+		std::string_view view() const { return m_view; }
+		bool empty() const { return m_view.empty(); }
+		std::string str() const { return std::string{m_view}; }
+
+	private:
+		static constexpr std::size_t m_inline {64};
+		char m_small[m_inline];
+		std::string m_large;
+		std::string_view m_view;
+	};
+}
+#endif
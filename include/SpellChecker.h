@@ -1,27 +1,103 @@
 #ifndef SPELLCHECKER_H
 #define SPELLCHECKER_H
 #include "Dictionary.h"
+#include "SymSpell.h"
+#include "BkTree.h"
+#include "BloomFilter.h"
+#include "ThreadPool.h"
 
 class SpellChecker
 {
 public:
+	// candidate generators for correct(), all return the same ranked words
+	enum class Engine
+	{
+		TrieWalk, // prune an edit distance walk over the dictionary trie (no extra memory)
+		SymSpell, // look up precomputed deletes (faster per query, index built on selection)
+		BkTree, // search a metric tree over the lexicon (index built on selection)
+	};
+
+	// autofill for one input field: keeps the trie position between keystrokes, so each
+	// keystroke is one descent (backspace a pop) instead of a new walk from the root
+	class Session
+	{
+	public:
+		explicit Session(const Dictionary &dict);
+
+		// both return the best completion of the text so far (empty if nothing matches)
+		const std::string &type(char c);
+		const std::string &backspace();
+		void clear();
+
+		const std::string &completion() const;
+		std::string ghost() const; // the part of completion() not typed yet, for inline display
+
+	private:
+		Trie::Cursor m_cursor;
+		std::vector<std::string> m_completions; // one per keystroke (plus empty input), so backspace needs no search
+	};
+
+	// how well the negative check filter is doing
+	struct FilterStats
+	{
+		std::size_t m_words {0};
+		std::size_t m_bytes {0};
+		double m_expectedRate {1.0}; // false positive rate predicted from the filter's fill
+		double m_measuredRate {1.0}; // share of random non-words the filter let through
+		std::size_t m_probes {0}; // non-words behind m_measuredRate
+	};
+
+	// a misspelled word in a document, by byte position in the text
+	struct Misspelling
+	{
+		std::size_t m_offset {0};
+		std::size_t m_length {0};
+		std::vector<std::string> m_corrections; // best first, only when asked for
+	};
+
 	explicit SpellChecker(const Dictionary &dict);
 	~SpellChecker() = default;
 
 	bool check(std::string_view word) const;
+
+	// every misspelled word of text in order; words are runs of letters (apostrophes inside them allowed),
+	// anything mixed with digits or non-ASCII bytes is skipped, and each distinct word is checked once
+	std::vector<Misspelling> checkDocument(std::string_view text, bool withCorrections = false) const;
+	// the same, split at word boundaries into chunks checked on pool (same results, same order)
+	std::vector<Misspelling> checkDocument(std::string_view text, ThreadPool &pool, bool withCorrections = false) const;
+	// verdict per word (true = spelled correctly), repeated words checked once
+	std::vector<bool> checkBatch(const std::vector<std::string_view> &words) const;
 	
 	void printSuggest(const std::vector<std::string> &out) const; // placeholder to print suggestions
 	
 	std::vector<std::string> suggest(std::string_view prefix) const;
 	std::vector<std::string> correct(std::string_view word) const;
 	
-	std::string autofill(std::string_view word) const;
+	std::string autofill(std::string_view word) const; // best completion of word, or word itself
+	Session startSession() const;
+
+	// selecting SymSpell or BkTree (re)builds its index from the dictionary, so reselect after adding words
+	void setEngine(Engine engine);
+	Engine getEngine() const;
+
+	// check() rejects most misspellings from a Bloom filter before touching the trie;
+	// built from the dictionary when enabled, and skipped once words are added after that
+	// (it can't tell they exist), so re-enable after adding words to get it back
+	void setFilter(bool enabled);
+	bool hasFilter() const;
+	FilterStats filterStats(std::size_t probes = 100000) const;
 private:
 	const Dictionary &m_dict;
+	Engine m_engine {Engine::TrieWalk};
+	SymSpell m_symSpell;
+	BkTree m_bkTree;
+	BloomFilter m_filter;
+	std::uint64_t m_filterGeneration {0}; // the dictionary's generation when m_filter was built
 
     /*********************************
     // Helper declarations go here
     **********************************/
 
+	void checkRange(std::string_view text, std::size_t begin, std::size_t end, bool withCorrections, std::vector<Misspelling> &out) const;
 };
 #endif
@@ -0,0 +1,60 @@
+#ifndef SYMSPELL_H
+#define SYMSPELL_H
+#include <string_view>
+#include <ostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Utils.h"
+
+// Symmetric delete correction index. Every word is stored under each string
+// reachable by deleting up to maxDistance letters from its first prefixLength
+// letters; a query makes the same deletes of itself, and any word sharing one
+// of those keys is a candidate, verified with the real edit distance.
+// Keys are 32-bit hashes in one sorted array (postings packed behind them),
+// so a lookup is a few array probes per delete instead of a walk over the lexicon.
+// prefixLength trades memory for latency: shorter prefixes mean fewer keys per
+// word, but larger posting lists to verify per query (0 indexes whole words).
+class SymSpell
+{
+public:
+	explicit SymSpell(int maxDistance = dct::g_maxEdit, std::size_t prefixLength = dct::g_symSpellPrefix);
+	~SymSpell() = default;
+
+	// build (replaces whatever was indexed before)
+	void build(const std::vector<std::string> &words);
+	bool loadFile(const std::string &filename); // word list, one per line
+	void clear();
+
+	// words within maxDistance edits of word (capped at the distance the index was built for), paired with their distance
+	void lookup(std::string_view word, int maxDistance, std::vector<std::pair<std::string, int>> &out) const;
+	bool isEmpty() const;
+	std::size_t size() const;
+	int maxDistance() const;
+
+	void memoryReport(std::ostream &out) const;
+
+private:
+	static constexpr int m_directoryBits {16}; // top hash bits that pick a range of m_keys
+
+	int m_maxDistance;
+	std::size_t m_prefixLength;
+
+	std::string m_text; // every word back to back
+	std::vector<std::uint32_t> m_offsets; // word i = m_text[m_offsets[i], m_offsets[i + 1])
+	std::vector<std::uint32_t> m_keys; // sorted unique delete hashes
+	std::vector<std::uint32_t> m_starts; // postings of m_keys[k] = m_postings[m_starts[k], m_starts[k + 1])
+	std::vector<std::uint32_t> m_postings; // word indices
+	std::vector<std::uint32_t> m_directory; // keys with top bits b live in m_keys[m_directory[b], m_directory[b + 1])
+
+    /*********************************
+    // Helper declarations go here
+    **********************************/
+	
+	std::string_view wordAt(std::uint32_t index) const;
+	void deletes(std::string_view word, int maxDistance, std::vector<std::uint32_t> &hashes) const;
+	void deletes(std::string &word, int remaining, std::vector<std::uint32_t> &hashes) const;
+	bool findKey(std::uint32_t hash, std::uint32_t &first, std::uint32_t &last) const;
+	static std::uint32_t hash(std::string_view key);
+};
+#endif
@@ -0,0 +1,83 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include "Utils.h"
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <cstddef>
+
+// Fixed set of worker threads, each with its own task deque. A worker takes
+// the newest task from its own deque (what it just queued is still in cache)
+// and, when that runs dry, steals the oldest task from another worker's, so
+// uneven tasks even out without one shared queue every thread fights over.
+// Tasks queued from inside a task stay on that worker's deque.
+// Work goes in through a TaskGroup, which is also what gets waited on.
+class ThreadPool
+{
+public:
+	// tasks that are waited for together. wait() only counts this group's tasks, so
+	// groups can share a pool, and a task can wait on a group of its own subtasks
+	class TaskGroup
+	{
+	public:
+		explicit TaskGroup(ThreadPool &pool) : m_pool{pool} {}
+		~TaskGroup(); // waits for whatever is still running; an exception nobody waited for is dropped
+		TaskGroup(const TaskGroup &) = delete;
+		TaskGroup &operator=(const TaskGroup &) = delete;
+
+		void submit(std::function<void()> task);
+		// blocks until every task submitted through this group has run, running queued tasks
+		// (of any group) itself meanwhile; rethrows the first exception one of them threw
+		void wait();
+
+	private:
+		ThreadPool &m_pool;
+		std::atomic<std::size_t> m_pending {0}; // queued or running
+		std::exception_ptr m_error; // under the pool's m_mutex
+
+		void drain();
+	};
+
+	explicit ThreadPool(unsigned threads = dct::g_checkThreads); // 0 = one per core
+	~ThreadPool(); // finishes what is queued, then joins
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	unsigned size() const;
+	std::size_t steals() const; // tasks run by a worker other than the one they were queued on
+
+private:
+	struct Queue
+	{
+		std::mutex m_mutex;
+		std::deque<std::function<void()>> m_tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> m_queues; // one per worker
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_mutex; // guards sleeping and waking, not the queues
+	std::condition_variable m_wake;
+	std::condition_variable m_done; // a group finished, or work was queued a waiting group could run
+	std::size_t m_queued {0}; // tasks sitting in a queue (under m_mutex)
+	std::atomic<std::size_t> m_steals {0};
+	std::atomic<unsigned> m_next {0}; // round robin for tasks submitted from outside the pool
+	bool m_stop {false};
+
+    /*********************************
+    // Helper declarations go here
+    **********************************/
+
+	void submit(std::function<void()> task);
+	void workerLoop(unsigned self);
+	unsigned self() const; // this thread's worker index, size() for a thread outside the pool
+	bool runOne(unsigned self);
+	bool take(unsigned self, std::function<void()> &task);
+};
+#endif
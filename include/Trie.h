@@ -5,20 +5,97 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cstdint>
+#include <array>
+#include "MappedFile.h"
+#include "Utils.h"
 
 class Trie
 {
 public:
+    // bulk loader for sorted input: keeps the path of the previous word, so each
+    // word only descends past the prefix it shares with the one before it
+    class Loader
+    {
+    public:
+        explicit Loader(Trie &trie);
+        bool add(std::string_view word, int word_id);
+
+    private:
+        Trie &m_trie;
+        std::vector<std::uint32_t> m_path; // m_path[i] = node after i letters of m_lastWord
+        std::string m_lastWord;
+    };
+
+    // walks down one keystroke at a time, keeping the path so backspace is a pop.
+    // Like an iterator, it is invalidated by any change to the trie.
+    class Cursor
+    {
+    public:
+        explicit Cursor(const Trie &trie);
+
+        void push(char c); // letters descend (either case), anything else is skipped like normalize() does
+        void pop(); // undo the last push
+        void reset();
+
+        bool isValid() const; // some word starts with the letters pushed so far
+        bool isWord() const;
+        std::string_view prefix() const; // normalized letters pushed so far
+        std::string best() const; // best scoring word starting with prefix(), empty if none
+
+    private:
+        struct Step {
+            std::uint32_t m_node {0}; // m_dead once the letters left the trie
+            bool m_isLetter {false}; // whether this keystroke added to m_prefix
+        };
+        static constexpr std::uint32_t m_dead {UINT32_MAX};
+
+        const Trie &m_trie;
+        std::vector<Step> m_path; // m_path[0] is the root, then one step per keystroke
+        std::string m_prefix;
+    };
+
+    // a stored word with what the trie keeps about it
+    struct WordEntry {
+        std::string m_word;
+        int m_wordID {-1}; // for a form, its lemma's
+        std::uint32_t m_score {0};
+        bool m_isForm {false};
+    };
+
     Trie();
-    ~Trie();
+    ~Trie() = default;
 
-    bool insert(std::string_view word, int word_id);
-    bool remove(std::string &word);
+    // reads (contains, startsWith, getPrefix, collectWithPrefix, dumpWord, Cursor) take raw text and
+    // normalize as they descend: case is folded and anything but a letter skipped, with no copy made.
+    // Writes expect a word that is already normalized.
+    bool insert(std::string_view word, int word_id); // a form already stored under word becomes this lemma
+    // an inflected form ("running"), stored as a word of its own that resolves to its lemma's id;
+    // shares its prefix nodes with the lemma and everything else, and never replaces a lemma
+    bool insertForm(std::string_view form, int lemma_id);
+    bool remove(std::string_view word);
     bool contains(std::string_view word) const;
 	bool startsWith(std::string_view prefix) const;
 	bool isEmpty() const;
+	int findID(std::string_view word) const; // the lemma's word_id, for a lemma or any of its forms; -1 if absent
+	bool isForm(std::string_view word) const;
+
+	// the limit highest scoring words starting with prefix, best first (alphabetical among equal scores),
+	// leaving out the prefix itself when withPrefix is false
+	void collectWithPrefix(std::string_view prefix, std::vector<std::string> &out, std::size_t limit, bool withPrefix = true) const;
+	void collectAll(std::vector<std::string> &out) const; // every word, alphabetical
+	void collectEntries(std::vector<WordEntry> &out) const; // every word with its id and score, alphabetical
 
-	void collectWithPrefix(std::string_view prefix, std::vector<std::string> &out, std::size_t limit) const;
+	// precompute the best completions of hot prefixes (every prefix up to depth letters, and any
+	// prefix with at least minWords words below it), so collectWithPrefix answers them from a
+	// table instead of a search. Saved with the image. insert, insertForm, remove and setScore
+	// redo the rows of the word's prefixes, setShard those under its letter; bulk loads (Loader, adoptShards) drop it.
+	void buildTopTable(std::size_t depth = dct::g_topDepth, std::size_t minWords = dct::g_topMinWords, 
+		std::size_t limit = dct::g_maxSuggest + 1);
+	bool hasTopTable() const;
+	void clearTopTable(); // ahead of many writes, cheaper than keeping it up to date through them
+	// words within maxDistance edits (insert, delete, substitute, swap adjacent letters), paired with their distance
+	void collectWithinDistance(std::string_view word, int maxDistance, std::vector<std::pair<std::string, int>> &out) const;
     void writeAll(std::ostream &out) const;
     void print() const;
     void dump() const;
@@ -27,31 +104,122 @@ public:
 
 	std::string getPrefix(std::string_view word) const;
 
+	// shards: the subtree under each first letter. A shard can be built as a Trie of its own (say on
+	// another thread) and copied in, replacing whatever was under that letter; the rest is untouched
+	bool setShard(char letter, const Trie &shard); // shard's words under letter, an empty shard drops the letter
+	// the same for every letter at once (shards[i] holds the words under 'a' + i), moving each shard's whole
+	// arena over (appended and reindexed, no per node copy) and leaving it empty; for building from
+	// scratch, since space freed from the letters replaced is not reused
+	void adoptShards(std::vector<Trie> &shards);
+	void shardReport(std::ostream &out) const; // words and bytes under each first letter
+
+	// ranking weight of a stored word (e.g. its corpus frequency), 0 until set
+	bool setScore(std::string_view word, std::uint32_t score);
+	std::uint32_t getScore(std::string_view word) const;
+	void memoryReport(std::ostream &out) const;
+
+	// binary image: written compacted, then mapped read-only and queried in place
+	bool save(const std::string &filename, std::uint64_t stamp) const;
+	bool load(const std::string &filename, std::uint64_t stamp); // fails on a bad or stale image
+	bool isMapped() const;
+
 private:
+    // compact node: a bitmap of which letters have children plus the index of
+    // a packed block in m_edges holding only the children that exist (ordered by letter)
     struct TrieNode {
-        TrieNode *m_children[26];
-        bool m_isEndOfWord {false};
+        std::uint32_t m_childMask {0}; // bit i set -> child for 'a' + i
+        std::uint32_t m_children {0}; // first slot in m_edges (next free node while on the free list)
 		int m_wordID {-1};
+        std::uint32_t m_score {0}; // of the word ending here
+        std::uint32_t m_maxScore {0}; // best m_score in this subtree, lets top-k search skip whole subtrees
+        bool m_isEndOfWord {false};
+        bool m_isForm {false}; // the word ending here is an inflected form, m_wordID is its lemma's
+
+        bool hasChild(int index) const { return m_childMask & (1u << index); }
+        bool hasChildren() const { return m_childMask != 0; }
+        int childCount() const { return __builtin_popcount(m_childMask); }
+        int slot(int index) const { return __builtin_popcount(m_childMask & ((1u << index) - 1)); } // position in packed block
+    };
 
-        TrieNode()
-        {
-            for (int i = 0; i < 26; ++i)
-            {
-                m_children[i] = nullptr;
-            }
-        }
+    // completion table: entries sorted by node, each owning the words up to the next entry's m_first
+    struct TopEntry {
+        std::uint32_t m_node {0};
+        std::uint32_t m_first {0}; // first word in m_topWords
     };
+    struct TopWord {
+        std::uint32_t m_offset {0}; // into m_topText
+        std::uint32_t m_length {0};
+    };
+
+    // node 0 is always the root, which is never anyone's child, so 0 doubles as "no node"
+    static constexpr std::uint32_t m_nil {0};
+
+    // arena: nodes and child blocks are addressed by 32 bit indices
+    std::vector<TrieNode> m_nodes;
+    std::vector<std::uint32_t> m_edges;
 
-    TrieNode *m_root;
+    // read path: points at the arena, or at a mapped image until the first write
+    const TrieNode *m_nodeView {nullptr};
+    const std::uint32_t *m_edgeView {nullptr};
+    MappedFile m_image;
+    std::uint32_t m_imageNodes {0};
+    std::uint32_t m_imageEdges {0};
+
+    // completion table, viewed the same way (m_topEntryCount real entries plus one closing sentinel)
+    std::vector<TopEntry> m_topEntries;
+    std::vector<TopWord> m_topWords;
+    std::string m_topText;
+    const TopEntry *m_topEntryView {nullptr};
+    const TopWord *m_topWordView {nullptr};
+    const char *m_topTextView {nullptr};
+    std::uint32_t m_topEntryCount {0};
+    std::uint32_t m_topTextSize {0};
+    std::uint32_t m_topLimit {0}; // completions kept per prefix
+    std::uint32_t m_topDepth {0}; // which prefixes are hot, as buildTopTable was given them
+    std::uint32_t m_topMinWords {0};
+    std::size_t m_topDead {0}; // text of words dropped from rows since it was last packed (some may live on in another row)
+
+    // free lists for reuse after remove (a free edge block stores the next block in its first slot)
+    std::uint32_t m_freeNodes {m_nil};
+    std::array<std::uint32_t, 27> m_freeEdges {}; // indexed by block size, 0 = empty list
 
     /*********************************
     // Helper declarations go here
     **********************************/
-    bool remove(TrieNode *&node, std::string_view word);
+    bool remove(std::uint32_t node, std::string_view word);
+
+    const TrieNode &nodeAt(std::uint32_t index) const { return m_nodeView[index]; }
+    std::uint32_t child(std::uint32_t node, int index) const;
+    void refreshMaxScore(std::uint32_t node);
+    void syncView();
+    void detach();
+    std::uint32_t addChild(std::uint32_t node, int index);
+    void eraseChild(std::uint32_t node, int index);
+    std::uint32_t allocNode();
+    void freeNode(std::uint32_t node);
+    std::uint32_t allocEdges(int size);
+    void freeEdges(std::uint32_t block, int size);
+    void freeSubtree(std::uint32_t node);
+    void dropShard(int index);
+    void adoptShard(int index, Trie &shard);
+    void copySubtree(std::uint32_t node, const Trie &from, std::uint32_t source); // into node, already allocated
 
-    void deleteTrie(TrieNode *node);
-    void rewrite(const TrieNode *node, std::string &currentWord, std::ostream &out) const;
-    void dumpNode(const TrieNode *node, const std::string &prefix) const;
-	void collectFromNode(const TrieNode *node, std::string &currentWord, std::vector<std::string> &out, std::size_t limit) const;
+    void rewrite(std::uint32_t node, std::string &currentWord, std::ostream &out) const;
+    void dumpNode(std::uint32_t node, const std::string &prefix) const;
+	void collectFromNode(std::uint32_t node, std::string &currentWord, std::vector<std::string> &out, std::size_t limit) const;
+	void collectEntries(std::uint32_t node, std::string &currentWord, std::vector<WordEntry> &out) const;
+	void collectBest(std::uint32_t node, std::string_view prefix, std::vector<std::string> &out, std::size_t limit, bool withPrefix) const;
+	void bestWord(std::uint32_t node, std::string &currentWord) const;
+	bool collectFromTable(std::uint32_t node, std::size_t depth, std::vector<std::string> &out, std::size_t limit, bool withPrefix) const;
+	void refreshTopRows(std::string_view word, const std::vector<std::uint32_t> &before = {}); // before: word's path ahead of a remove
+	void setTopRow(std::uint32_t node, const std::vector<std::string> &words); // no words drops the row
+	void packTopText();
+	void refreshShardRows(int index); // after setShard replaced the letter
+	std::size_t countWords(std::uint32_t node, std::size_t limit) const; // stops at limit
+	std::size_t selectHotNodes(std::uint32_t node, std::string &currentWord, std::size_t depth, std::size_t minWords,
+		std::vector<std::pair<std::uint32_t, std::string>> &hot) const;
+	void walkDistance(std::uint32_t node, std::string_view word, int maxDistance, std::vector<int> &rows, 
+		std::string &currentWord, std::vector<std::pair<std::string, int>> &out) const;
+	void countNodes(std::uint32_t node, std::size_t &nodes, std::size_t &edges, std::size_t &words) const;
 };
 #endif
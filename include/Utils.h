@@ -1,11 +1,39 @@
 #ifndef UTILS_H
-#define UTLS_H
+#define UTILS_H
+#include <cstddef>
+#include <cstdint>
 
 namespace dct 
 {
         inline constexpr const char *g_dictTxt {"dictionary.txt"}; // inline to avoid linker errors
         inline constexpr const char *g_dictDb {"dictionary.db"}; // inline to avoid linker errors
+        inline constexpr const char *g_dictImg {"dictionary.trie"}; // mapped trie image, rebuilt from g_dictDb when stale
+        inline constexpr const char *g_dictFreq {"frequency.txt"}; // optional "word count" lines that rank suggestions
         inline constexpr const int g_alpha {26};
 	    inline constexpr const int g_maxSuggest {10};
+	    inline constexpr const std::size_t g_topDepth {3}; // prefixes up to this long get precomputed completions
+	    inline constexpr const std::size_t g_topMinWords {1000}; // ... and so does any prefix with this many words below it
+	    inline constexpr const int g_maxEdit {2}; // furthest correction offered by SpellChecker::correct
+	    inline constexpr const std::size_t g_symSpellPrefix {7}; // letters of each word indexed by SymSpell, 0 = whole word
+	    inline constexpr const std::size_t g_bloomBits {10}; // filter bits per dictionary word (about 1% false positives)
+	    inline constexpr const unsigned g_checkThreads {0}; // ThreadPool workers for parallel document checks, 0 = one per core
+	    inline constexpr const std::size_t g_checkChunk {1 << 16}; // smallest piece of a document handed to one task (bytes)
+	    inline constexpr const unsigned g_buildThreads {0}; // trie shards built at once when rebuilding from the database, 0 = one per core
+	    inline constexpr const std::size_t g_cacheBytes {16 << 20}; // hydrated WordInfo entries kept in memory
+	    inline constexpr const long long g_dbMapBytes {1ll << 30}; // of the database file read through a memory map rather than copied in, 0 = off
+	    inline constexpr const std::size_t g_importBatch {50000}; // entries per transaction during bulk import
+	    inline constexpr const unsigned g_importThreads {0}; // parser threads during import, 0 = one per core
+	    inline constexpr const std::size_t g_importLines {256}; // JSONL lines handed to a parser thread at a time
+
+        // xorshift64: cheap pseudo-random numbers from a fixed seed, so benchmark and sampling runs compare
+        class XorShift
+        {
+        public:
+                explicit XorShift(std::uint64_t seed = 88172645463325252ull) : m_state{seed} {}
+                std::uint64_t operator()() { m_state ^= m_state << 13; m_state ^= m_state >> 7; m_state ^= m_state << 17; return m_state; }
+
+        private:
+                std::uint64_t m_state;
+        };
 }
 #endif
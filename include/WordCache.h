@@ -0,0 +1,84 @@
+#ifndef WORDCACHE_H
+#define WORDCACHE_H
+#include "WordInfo.h"
+#include "Utils.h"
+#include <unordered_map>
+#include <ostream>
+#include <memory>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <cstdint>
+
+// Hydrated WordInfo entries by word_id, bounded by their size in bytes.
+// Eviction is LRU, admission is TinyLFU: a count-min sketch remembers roughly
+// how often each word_id was asked for (recent requests weigh more, all counts
+// are halved every so often), and when the cache is full a new entry only gets
+// in if it has been asked for more often than the entry it would evict. A burst
+// of one-off lookups (a scan) then can't flush the words that keep coming back.
+// Entries are handed out as shared pointers, so an eviction never frees one a
+// caller still holds. Safe to share between threads.
+class WordCache
+{
+public:
+	struct Stats
+	{
+		std::size_t m_hits {0};
+		std::size_t m_misses {0};
+		std::size_t m_evictions {0};
+		std::size_t m_rejected {0}; // misses not admitted
+		std::size_t m_entries {0};
+		std::size_t m_bytes {0};
+		std::size_t m_capacity {0};
+	};
+
+	explicit WordCache(std::size_t capacityBytes = dct::g_cacheBytes, bool admission = true); // no admission = plain LRU
+	~WordCache() = default;
+	WordCache(const WordCache &) = delete;
+	WordCache &operator=(const WordCache &) = delete;
+
+	std::shared_ptr<const WordInfo> find(int word_id); // nullptr on a miss, which still counts towards admission
+	// caches info if admitted; either way returns it as a shared pointer
+	std::shared_ptr<const WordInfo> insert(int word_id, WordInfo &&info);
+	void erase(int word_id); // after the word changes in the database
+	void clear();
+
+	Stats stats() const;
+	void memoryReport(std::ostream &out) const;
+	static std::size_t bytes(const WordInfo &info); // heap and inline size
+
+private:
+	struct Entry
+	{
+		int m_wordID;
+		std::shared_ptr<const WordInfo> m_info;
+		std::size_t m_bytes;
+	};
+
+	static constexpr int m_rows {4};
+	static constexpr std::uint8_t m_maxCount {15};
+
+	std::size_t m_capacity;
+	bool m_admission;
+
+	mutable std::mutex m_mutex;
+	std::list<Entry> m_lru; // most recent first
+	std::unordered_map<int, std::list<Entry>::iterator> m_index;
+	std::size_t m_bytes {0};
+
+	// count-min sketch, m_rows rows of m_width counters
+	std::vector<std::uint8_t> m_sketch;
+	std::size_t m_width;
+	std::size_t m_additions {0}; // since the last halving
+	Stats m_stats;
+
+    /*********************************
+    // Helper declarations go here
+    **********************************/
+
+	void record(int word_id);
+	std::uint8_t frequency(int word_id) const;
+	std::size_t slot(int word_id, int row) const;
+	void evictLast();
+};
+#endif
@@ -0,0 +1,31 @@
+#ifndef WORDINFO_H
+#define WORDINFO_H
+#include <vector>
+#include <string>
+
+// represent word info from the db in memory
+struct WordInfo
+{
+   	std::string lemma; // word
+    std::vector<std::string> etymology;
+    int id{-1}; // ??
+    
+    // plurals or alternative spellings
+    struct Form
+    {
+    	std::string form;
+    	std::string tag;
+    };
+    std::vector<Form> forms; 
+    
+    struct Sense
+ 	{
+ 	    std::string pos; // noun, verb, adj, etc.
+ 	    std::string definition;
+ 	    std::vector<std::string> examples;
+  	    std::vector<std::string> synonyms;
+ 	    std::vector<std::string> antonyms;
+ 	};
+    std::vector<Sense> senses; // acts a 'cache'
+};
+#endif
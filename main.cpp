@@ -1,9 +1,1098 @@
 // Fall 2025 - Dictionary/Spell Checker - Collaborative Project
 #include "Dictionary.h"
 #include "SpellChecker.h"
+#include "Dawg.h"
+#include "SymSpell.h"
+#include "BkTree.h"
+#include "BloomFilter.h"
+#include "ThreadPool.h"
+#include "ConcurrentTrie.h"
+#include "WordCache.h"
+#include "EditDistance.h"
+#include "Normalize.h"
+#include "Utils.h"
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <cctype>
+#include <cmath>
+#include <shared_mutex>
+#include <tuple>
+#include <algorithm>
+
+// counts every heap allocation so the tester can check which paths make none. That costs every
+// allocation in the program an atomic increment, so it is only built in along with the benchmark
+// that reads it (add -DDCT_COUNT_ALLOCATIONS to CXXFLAGS in the Makefile)
+#ifdef DCT_COUNT_ALLOCATIONS
+static std::atomic<std::size_t> g_allocations {0};
+
+void *operator new(std::size_t size)
+{
+	++g_allocations;
+	if (void *p {std::malloc(size ? size : 1)}) return p;
+	throw std::bad_alloc{};
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+#endif
 
 class Tester
 {
+public:
+	// a word list, one word per line, stopping after limit words
+	static std::vector<std::string> loadWords(const std::string &filename, std::size_t limit = SIZE_MAX)
+	{
+		std::ifstream file(filename);
+		std::vector<std::string> words;
+		std::string word;
+		while (words.size() < limit && std::getline(file, word)) words.push_back(word);
+		return words;
+	}
+
+	// words (sorted, as the word lists are) into trie, words[i] with word_id i + 1
+	static void loadTrie(Trie &trie, const std::vector<std::string> &words)
+	{
+		Trie::Loader loader {trie};
+		for (std::size_t i{0}; i < words.size(); ++i) loader.add(words[i], static_cast<int>(i + 1));
+	}
+
+	// load a plain word list straight into a trie and report its memory footprint
+	static void trieMemory(const std::string &filename)
+	{
+		std::ifstream file(filename);
+		if (!file) return;
+
+		Trie trie;
+		std::string word;
+		int id {0};
+		while (std::getline(file, word)) trie.insert(word, ++id);
+
+		std::cout << "--- trie memory for " << filename << " ---\n";
+		trie.memoryReport(std::cout);
+	}
+
+	// build the read-only DAWG from a sorted word list and check every word maps back to its line
+	static void dawgBuild(const std::string &filename)
+	{
+		Dawg dawg;
+		if (!dawg.loadFile(filename)) return;
+
+		std::ifstream file(filename);
+		std::string word;
+		int id {0}, mismatches {0};
+		while (std::getline(file, word))
+		{
+			if (!dawg.contains(word) || dawg.getWordID(word) != ++id) ++mismatches;
+		}
+
+		std::cout << "--- dawg for " << filename << " ---\n";
+		dawg.memoryReport(std::cout);
+		std::cout << "mismatches: " << mismatches << '\n';
+	}
+
+	// rebuild the trie from the database: per-row getWordID (old path) vs one ordered (id, lemma) scan
+	static void buildTrieTime()
+	{
+		Dictionary dict;
+
+		auto start {std::chrono::steady_clock::now()};
+		Trie legacy;
+		sqlite3_stmt *stmt;
+		sqlite3_prepare_v2(dict.m_db.getDB(), "SELECT lemma FROM words;", -1, &stmt, nullptr);
+		while (sqlite3_step(stmt) == SQLITE_ROW)
+		{
+			std::string word {reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0))};
+			legacy.insert(word, dict.m_db.getWordID(word));
+		}
+		sqlite3_finalize(stmt);
+		std::chrono::duration<double, std::milli> oldPath {std::chrono::steady_clock::now() - start};
+
+		start = std::chrono::steady_clock::now();
+		dict.m_trie.clear();
+		dict.buildTrie(dict.m_db);
+		std::chrono::duration<double, std::milli> newPath {std::chrono::steady_clock::now() - start};
+
+		std::cout << "buildTrie: " << oldPath.count() << " ms (lemma + getWordID per row) -> " 
+			<< newPath.count() << " ms (ordered id, lemma scan)\n";
+	}
+
+	// buildShards against one sequential load, then swapping a single shard against rebuilding everything
+	static void shardedBuild(const std::string &filename)
+	{
+		std::ifstream file(filename);
+		std::vector<std::pair<int, std::string>> rows;
+		std::string word;
+		while (std::getline(file, word)) rows.emplace_back(static_cast<int>(rows.size() + 1), word);
+		std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b) { return a.second < b.second; });
+		if (rows.empty()) return;
+
+		auto start {std::chrono::steady_clock::now()};
+		Trie sequential;
+		{
+			Trie::Loader loader {sequential};
+			for (const auto &row : rows) loader.add(row.second, row.first);
+		}
+		std::chrono::duration<double, std::milli> serial {std::chrono::steady_clock::now() - start};
+		std::vector<Trie::WordEntry> expected;
+		sequential.collectEntries(expected);
+
+		std::cout << "--- trie build over " << rows.size() << " words (" << std::thread::hardware_concurrency() << " cores) ---\n"
+			<< "sequential: " << serial.count() << " ms\n";
+
+		std::vector<std::pair<int, std::string_view>> views;
+		for (const auto &row : rows) views.emplace_back(row.first, row.second);
+
+		Dictionary dict;
+		for (unsigned threads : {1u, 2u, 4u, 8u})
+		{
+			dict.m_trie.clear();
+			start = std::chrono::steady_clock::now();
+			dict.buildShards(views, threads);
+			std::chrono::duration<double, std::milli> elapsed {std::chrono::steady_clock::now() - start};
+
+			std::vector<Trie::WordEntry> found;
+			dict.m_trie.collectEntries(found);
+			bool same {found.size() == expected.size()};
+			for (std::size_t i{0}; same && i < found.size(); ++i) same = found[i].m_word == expected[i].m_word && found[i].m_wordID == expected[i].m_wordID;
+			std::cout << threads << " threads: " << elapsed.count() << " ms, speedup " << serial.count() / elapsed.count() << "x"
+				<< (same ? "" : " (MISMATCH)") << '\n';
+		}
+		dict.m_trie.shardReport(std::cout);
+
+		// reload the biggest letter from its rows alone
+		std::vector<std::size_t> counts(dct::g_alpha, 0);
+		for (const auto &row : rows) if (!row.second.empty() && row.second[0] >= 'a' && row.second[0] <= 'z') ++counts[row.second[0] - 'a'];
+		char letter {static_cast<char>('a' + (std::max_element(counts.begin(), counts.end()) - counts.begin()))};
+
+		start = std::chrono::steady_clock::now();
+		Trie shard;
+		{
+			Trie::Loader loader {shard};
+			for (const auto &row : rows) if (!row.second.empty() && row.second[0] == letter) loader.add(row.second, row.first);
+		}
+		dict.m_trie.setShard(letter, shard);
+		std::chrono::duration<double, std::milli> reload {std::chrono::steady_clock::now() - start};
+
+		std::vector<Trie::WordEntry> found;
+		dict.m_trie.collectEntries(found);
+		std::cout << "reload '" << letter << "' (" << counts[letter - 'a'] << " words): " << reload.count() << " ms vs "
+			<< serial.count() << " ms for everything" << (found.size() == expected.size() ? "" : " (MISMATCH)") << '\n';
+	}
+
+	// parse a Wiktextract JSONL file without touching the database: DOM per line vs SAX into a recycled WordInfo
+	static void ingestion(const std::string &filename)
+	{
+		std::ifstream file(filename);
+		if (!file) return;
+
+		std::string line;
+		std::size_t bytes {0}, domEntries {0}, saxEntries {0};
+
+		auto start {std::chrono::steady_clock::now()};
+		while (std::getline(file, line))
+		{
+			bytes += line.size() + 1;
+			nlohmann::json j = nlohmann::json::parse(line, nullptr, false);
+			if (!j.is_discarded() && j.contains("word")) ++domEntries;
+		}
+		std::chrono::duration<double> dom {std::chrono::steady_clock::now() - start};
+
+		file.clear();
+		file.seekg(0);
+		EntryParser parser;
+		start = std::chrono::steady_clock::now();
+		while (std::getline(file, line))
+		{
+			if (parser.parse(line)) ++saxEntries;
+		}
+		std::chrono::duration<double> sax {std::chrono::steady_clock::now() - start};
+
+		double mb {bytes / (1024.0 * 1024.0)};
+		std::cout << "--- ingestion of " << filename << " (" << mb << " MB) ---\n"
+			<< "dom: " << domEntries << " entries, " << mb / dom.count() << " MB/s\n"
+			<< "sax: " << saxEntries << " entries, " << mb / sax.count() << " MB/s\n";
+	}
+
+	// misspell every 997th word of a word list with one edit (swap, drop or replace a letter)
+	static std::vector<std::string> misspellings(const std::vector<std::string> &words)
+	{
+		std::vector<std::string> out;
+		for (std::size_t i{0}; i < words.size(); i += 997)
+		{
+			std::string word {words[i]};
+			if (word.size() < 3) continue;
+
+			std::size_t pos {i % (word.size() - 1)};
+			if (i % 3 == 0) std::swap(word[pos], word[pos + 1]);
+			else if (i % 3 == 1) word.erase(pos, 1);
+			else word[pos] = static_cast<char>('a' + (word[pos] - 'a' + 7) % dct::g_alpha);
+			out.push_back(word);
+		}
+		return out;
+	}
+
+	// correction latency: pruned trie walk vs comparing the query against every word
+	static void correctionLatency(const std::string &filename)
+	{
+		std::vector<std::string> words {loadWords(filename)};
+
+		Trie trie;
+		loadTrie(trie, words);
+		std::vector<std::string> queries {misspellings(words)};
+		if (queries.empty()) return;
+
+		std::size_t found {0};
+		auto start {std::chrono::steady_clock::now()};
+		for (const auto &query : queries)
+		{
+			std::vector<std::pair<std::string, int>> out;
+			trie.collectWithinDistance(query, dct::g_maxEdit, out);
+			found += out.size();
+		}
+		std::chrono::duration<double, std::micro> walk {std::chrono::steady_clock::now() - start};
+
+		std::size_t bruteQueries {std::min<std::size_t>(queries.size(), 20)}, bruteFound {0};
+		start = std::chrono::steady_clock::now();
+		for (std::size_t q{0}; q < bruteQueries; ++q)
+		{
+			for (const auto &candidate : words)
+			{
+				if (dct::editDistance(queries[q], candidate) <= dct::g_maxEdit) ++bruteFound;
+			}
+		}
+		std::chrono::duration<double, std::micro> brute {std::chrono::steady_clock::now() - start};
+
+		double walkUs {walk.count() / queries.size()}, bruteUs {brute.count() / bruteQueries};
+		std::cout << "--- correction over " << queries.size() << " misspellings ---\n"
+			<< "trie walk:   " << walkUs << " us/query (" << found << " candidates)\n"
+			<< "brute force: " << bruteUs << " us/query (" << bruteFound << " candidates for " << bruteQueries << " queries)\n"
+			<< "speedup: " << bruteUs / walkUs << "x\n";
+	}
+
+	// SymSpell at a few prefix lengths and the BK-tree vs the trie walk: build time, memory, latency and agreement
+	static void correctionEngines(const std::string &filename)
+	{
+		std::vector<std::string> words {loadWords(filename)};
+
+		Trie trie;
+		loadTrie(trie, words);
+		std::vector<std::string> queries {misspellings(words)};
+		if (queries.empty()) return;
+
+		// queries no longer than the edit distance, which only the empty delete connects to their candidates
+		for (char a{'a'}; a <= 'z'; ++a)
+		{
+			queries.push_back(std::string{a});
+			for (char b : {'e', 'q', 'x'}) queries.push_back(std::string{a, b});
+		}
+
+		// ranked trie walk results are the reference every engine has to reproduce
+		std::vector<std::vector<std::string>> expected(queries.size());
+		auto start {std::chrono::steady_clock::now()};
+		for (std::size_t q{0}; q < queries.size(); ++q)
+		{
+			std::vector<std::pair<std::string, int>> out;
+			trie.collectWithinDistance(queries[q], dct::g_maxEdit, out);
+			dct::rankCandidates(out, expected[q], dct::g_maxSuggest);
+		}
+		std::chrono::duration<double, std::micro> walk {std::chrono::steady_clock::now() - start};
+
+		std::cout << "--- correction engines over " << queries.size() << " misspellings ---\n"
+			<< "trie walk: " << walk.count() / queries.size() << " us/query\n";
+
+		for (std::size_t prefixLength : {std::size_t{5}, dct::g_symSpellPrefix, std::size_t{0}})
+		{
+			SymSpell index {dct::g_maxEdit, prefixLength};
+			start = std::chrono::steady_clock::now();
+			index.build(words);
+			std::chrono::duration<double, std::milli> build {std::chrono::steady_clock::now() - start};
+
+			std::size_t mismatches {0};
+			start = std::chrono::steady_clock::now();
+			for (std::size_t q{0}; q < queries.size(); ++q)
+			{
+				std::vector<std::pair<std::string, int>> out;
+				std::vector<std::string> results;
+				index.lookup(queries[q], dct::g_maxEdit, out);
+				dct::rankCandidates(out, results, dct::g_maxSuggest);
+				if (results != expected[q]) ++mismatches;
+			}
+			std::chrono::duration<double, std::micro> lookup {std::chrono::steady_clock::now() - start};
+
+			std::cout << "\nsymspell prefix " << prefixLength << ": " << lookup.count() / queries.size() << " us/query, built in "
+				<< build.count() << " ms, " << mismatches << " mismatches\n";
+			index.memoryReport(std::cout);
+		}
+
+		BkTree tree;
+		start = std::chrono::steady_clock::now();
+		tree.build(words);
+		std::chrono::duration<double, std::milli> build {std::chrono::steady_clock::now() - start};
+
+		std::size_t mismatches {0};
+		start = std::chrono::steady_clock::now();
+		for (std::size_t q{0}; q < queries.size(); ++q)
+		{
+			std::vector<std::pair<std::string, int>> out;
+			std::vector<std::string> results;
+			tree.lookup(queries[q], dct::g_maxEdit, out);
+			dct::rankCandidates(out, results, dct::g_maxSuggest);
+			if (results != expected[q]) ++mismatches;
+		}
+		std::chrono::duration<double, std::micro> lookup {std::chrono::steady_clock::now() - start};
+
+		std::cout << "\nbk-tree: " << lookup.count() / queries.size() << " us/query, built in "
+			<< build.count() << " ms, " << mismatches << " mismatches\n";
+		tree.memoryReport(std::cout);
+	}
+
+	// edit distance verification throughput: DP table vs bit-parallel, one at a time and batched
+	static void distanceKernels(const std::string &filename)
+	{
+		std::vector<std::string> words {loadWords(filename)};
+
+		std::vector<std::string> queries {misspellings(words)};
+		if (queries.size() > 50) queries.resize(50);
+		std::vector<std::string_view> candidates(words.begin(), words.end());
+		std::vector<int> batched(candidates.size());
+		double total {static_cast<double>(queries.size() * candidates.size())};
+
+		long dpSum {0}, scalarSum {0}, batchSum {0};
+		auto start {std::chrono::steady_clock::now()};
+		for (const auto &query : queries)
+		{
+			for (auto candidate : candidates) dpSum += dct::editDistance(query, candidate);
+		}
+		std::chrono::duration<double> dp {std::chrono::steady_clock::now() - start};
+
+		start = std::chrono::steady_clock::now();
+		for (const auto &query : queries)
+		{
+			dct::EditPattern pattern {query};
+			for (auto candidate : candidates) scalarSum += pattern.distance(candidate);
+		}
+		std::chrono::duration<double> scalar {std::chrono::steady_clock::now() - start};
+
+		start = std::chrono::steady_clock::now();
+		for (const auto &query : queries)
+		{
+			dct::EditPattern pattern {query};
+			pattern.distances(candidates.data(), candidates.size(), batched.data());
+			for (int distance : batched) batchSum += distance;
+		}
+		std::chrono::duration<double> batch {std::chrono::steady_clock::now() - start};
+
+		std::cout << "--- edit distance over " << queries.size() << " x " << candidates.size() << " pairs ---\n"
+			<< "dp table:     " << total / dp.count() / 1e6 << " M candidates/s\n"
+			<< "bit-parallel: " << total / scalar.count() / 1e6 << " M candidates/s\n"
+			<< "batched (" << dct::EditPattern::batchKernel() << "): " << total / batch.count() / 1e6 << " M candidates/s\n"
+			<< "checksums " << (dpSum == scalarSum && dpSum == batchSum ? "match" : "DIFFER") << '\n';
+	}
+
+	// top-10 completions for short prefixes: unscored (alphabetical), Zipf-like scores, precomputed table
+	static void rankedSuggest(const std::string &filename)
+	{
+		std::vector<std::string> words {loadWords(filename)};
+
+		Trie trie;
+		loadTrie(trie, words);
+
+		std::vector<std::string> prefixes;
+		for (char a{'a'}; a <= 'z'; ++a)
+		{
+			prefixes.push_back(std::string{a});
+			for (char b : {'a', 'e', 'h', 'o', 'r'}) prefixes.push_back(std::string{a, b});
+		}
+
+		auto timeQueries = [&]()
+		{
+			auto start {std::chrono::steady_clock::now()};
+			for (const auto &prefix : prefixes)
+			{
+				std::vector<std::string> out;
+				trie.collectWithPrefix(prefix, out, dct::g_maxSuggest);
+			}
+			std::chrono::duration<double, std::micro> elapsed {std::chrono::steady_clock::now() - start};
+			return elapsed.count() / prefixes.size();
+		};
+
+		double unscored {timeQueries()};
+
+		// stand-in for a corpus count file: a pseudo-random rank per word, count ~ 1 / rank
+		for (std::size_t i{0}; i < words.size(); ++i)
+		{
+			std::size_t rank {1 + (i * 2654435761u) % words.size()};
+			trie.setScore(words[i], static_cast<std::uint32_t>(100000000 / rank));
+		}
+		double scored {timeQueries()};
+
+		auto start {std::chrono::steady_clock::now()};
+		trie.buildTopTable(dct::g_topDepth, dct::g_topMinWords, dct::g_maxSuggest);
+		std::chrono::duration<double, std::milli> build {std::chrono::steady_clock::now() - start};
+		double table {timeQueries()};
+
+		std::vector<std::string> top;
+		trie.collectWithPrefix("th", top, 5);
+		std::cout << "--- top " << dct::g_maxSuggest << " completions over " << prefixes.size() << " prefixes ---\n"
+			<< "unscored: " << unscored << " us/query\n"
+			<< "scored:   " << scored << " us/query\n"
+			<< "table:    " << table << " us/query (built in " << build.count() << " ms)\n";
+		trie.memoryReport(std::cout);
+		std::cout << "th ->";
+		for (const auto &completion : top) std::cout << ' ' << completion << '(' << trie.getScore(completion) << ')';
+		std::cout << '\n';
+	}
+
+	// autofill per keystroke: cursor kept between keystrokes vs walking the prefix again each time
+	static void autofillLatency(const std::string &filename)
+	{
+		std::vector<std::string> words {loadWords(filename)};
+
+		Trie trie;
+		loadTrie(trie, words);
+		for (std::size_t i{0}; i < words.size(); ++i)
+		{
+			std::size_t rank {1 + (i * 2654435761u) % words.size()};
+			trie.setScore(words[i], static_cast<std::uint32_t>(100000000 / rank));
+		}
+		trie.buildTopTable();
+
+		// type every 997th word in full, then erase it
+		std::size_t keystrokes {0}, cursorHits {0}, rewalkHits {0};
+		auto start {std::chrono::steady_clock::now()};
+		for (std::size_t i{0}; i < words.size(); i += 997)
+		{
+			Trie::Cursor cursor {trie};
+			for (char c : words[i])
+			{
+				cursor.push(c);
+				cursorHits += !cursor.best().empty();
+				++keystrokes;
+			}
+			for (std::size_t k{0}; k < words[i].size(); ++k) cursor.pop();
+		}
+		std::chrono::duration<double, std::micro> session {std::chrono::steady_clock::now() - start};
+
+		start = std::chrono::steady_clock::now();
+		for (std::size_t i{0}; i < words.size(); i += 997)
+		{
+			for (std::size_t k{1}; k <= words[i].size(); ++k)
+			{
+				std::vector<std::string> out;
+				trie.collectWithPrefix(std::string_view{words[i]}.substr(0, k), out, 1);
+				rewalkHits += !out.empty();
+			}
+		}
+		std::chrono::duration<double, std::micro> rewalk {std::chrono::steady_clock::now() - start};
+
+		std::cout << "--- autofill over " << keystrokes << " keystrokes ---\n"
+			<< "session: " << session.count() / keystrokes << " us/keystroke (" << cursorHits << " completions)\n"
+			<< "re-walk: " << rewalk.count() / keystrokes << " us/keystroke (" << rewalkHits << " completions)\n";
+	}
+
+#ifdef DCT_COUNT_ALLOCATIONS
+	// raw mixed case lookups should normalize without touching the heap
+	static void lookupAllocations(const std::string &filename)
+	{
+		std::vector<std::string> words {loadWords(filename)}, queries;
+
+		Trie trie;
+		loadTrie(trie, words);
+
+		// the way words arrive from text: capitalized, punctuated, shouted
+		for (std::size_t i{0}; i < words.size(); i += 7)
+		{
+			std::string raw {words[i]};
+			if (i % 3 == 0) raw[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(raw[0])));
+			if (i % 3 == 1) for (char &c : raw) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+			if (i % 2 == 0) raw += ",";
+			if (i % 5 == 0) raw = "\"" + raw + "\"";
+			queries.push_back(raw);
+		}
+
+		std::size_t found {0}, prefixes {0}, letters {0};
+		std::size_t before {g_allocations.load()};
+		auto start {std::chrono::steady_clock::now()};
+		for (const std::string &query : queries)
+		{
+			found += trie.contains(query);
+			prefixes += trie.startsWith(std::string_view{query}.substr(0, 3));
+			dct::NormalizedWord clean {query};
+			letters += clean.view().size();
+		}
+		std::chrono::duration<double, std::micro> elapsed {std::chrono::steady_clock::now() - start};
+		std::size_t allocations {g_allocations.load() - before};
+
+		// the old path: a fresh normalized string per query
+		std::size_t copies {0};
+		before = g_allocations.load();
+		start = std::chrono::steady_clock::now();
+		for (const std::string &query : queries)
+		{
+			std::string clean;
+			for (char c : query) if (std::isalpha(static_cast<unsigned char>(c))) clean.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+			copies += trie.contains(clean);
+		}
+		std::chrono::duration<double, std::micro> copied {std::chrono::steady_clock::now() - start};
+		std::size_t copyAllocations {g_allocations.load() - before};
+
+		// normalizing a whole batch in one buffer vs one string per word
+		std::vector<std::string_view> views(queries.begin(), queries.end()), out;
+		std::string buffer;
+		std::size_t bytes {0};
+		for (const std::string &query : queries) bytes += query.size();
+		start = std::chrono::steady_clock::now();
+		dct::normalizeBatch(views.data(), views.size(), buffer, out);
+		// once the buffers have grown, later batches must reuse them
+		before = g_allocations.load();
+		for (int r{1}; r < 20; ++r) dct::normalizeBatch(views.data(), views.size(), buffer, out);
+		std::size_t batchAllocations {g_allocations.load() - before};
+		std::chrono::duration<double> batch {std::chrono::steady_clock::now() - start};
+
+		std::size_t checksum {0};
+		start = std::chrono::steady_clock::now();
+		for (int r{0}; r < 20; ++r)
+		{
+			for (const std::string &query : queries)
+			{
+				std::string clean(query.size(), '\0');
+				clean.resize(dct::normalizeInto(query, clean.data()));
+				checksum += clean.size();
+			}
+		}
+		std::chrono::duration<double> single {std::chrono::steady_clock::now() - start};
+
+		std::cout << "--- raw lookups over " << queries.size() << " queries ---\n"
+			<< "in place: " << elapsed.count() / queries.size() << " us/query, " << allocations << " allocations (found " << found 
+			<< ", prefixes " << prefixes << ", letters " << letters << ")" << (allocations == 0 ? "" : " (MISMATCH)") << '\n'
+			<< "copied:   " << copied.count() / queries.size() << " us/query, " << copyAllocations << " allocations (found " << copies << ")\n"
+			<< "normalizeBatch: " << 20 * bytes / batch.count() / 1e6 << " MB/s, per word: " << 20 * bytes / single.count() / 1e6 
+			<< " MB/s (" << checksum / 20 << " letters), " << batchAllocations << " allocations after the first batch"
+			<< (batchAllocations == 0 ? "" : " (MISMATCH)") << '\n';
+	}
+#endif
+
+	// misspelled tokens: trie descent alone vs the blocked Bloom filter in front of it
+	static void filterCheck(const std::string &filename)
+	{
+		std::vector<std::string> words {loadWords(filename)};
+
+		Trie trie;
+		loadTrie(trie, words);
+		BloomFilter filter;
+		filter.build(words);
+
+		// one typo per word (a changed letter), keeping only the ones that really are misspelled
+		std::vector<std::string> typos;
+		for (std::size_t i{0}; i < words.size(); ++i)
+		{
+			std::string typo {words[i]};
+			if (typo.empty()) continue;
+			std::size_t at {(i * 7) % typo.size()};
+			typo[at] = static_cast<char>('a' + (typo[at] - 'a' + 1 + i % 25) % dct::g_alpha);
+			if (!trie.contains(typo)) typos.push_back(typo);
+		}
+
+		auto time {[](const std::vector<std::string> &queries, auto &&check)
+		{
+			std::size_t hits {0};
+			auto start {std::chrono::steady_clock::now()};
+			for (int r{0}; r < 5; ++r) for (const auto &query : queries) hits += check(query);
+			std::chrono::duration<double, std::nano> elapsed {std::chrono::steady_clock::now() - start};
+			return std::make_pair(elapsed.count() / (5 * queries.size()), hits / 5);
+		}};
+		auto trieOnly {[&trie](const std::string &w) { return trie.contains(w); }};
+		auto filtered {[&](const std::string &w) { return filter.mayContain(w) && trie.contains(w); }};
+		auto passes {[&filter](const std::string &w) { return filter.mayContain(w); }};
+
+		auto [typoTrie, typoTrieHits] {time(typos, trieOnly)};
+		auto [typoFilter, typoFilterHits] {time(typos, filtered)};
+		auto [wordTrie, wordTrieHits] {time(words, trieOnly)};
+		auto [wordFilter, wordFilterHits] {time(words, filtered)};
+		std::size_t falsePositives {time(typos, passes).second};
+
+		std::cout << "--- negative checks over " << typos.size() << " typos, " << words.size() << " words ---\n";
+		filter.memoryReport(std::cout);
+		std::cout << "measured false positives: " << 100.0 * falsePositives / typos.size() << "%\n"
+			<< "typos: trie " << typoTrie << " ns, filter + trie " << typoFilter << " ns (" << typoTrieHits << "/" << typoFilterHits << " found)\n"
+			<< "words: trie " << wordTrie << " ns, filter + trie " << wordFilter << " ns (" << wordTrieHits << "/" << wordFilterHits << " found)\n";
+	}
+
+	// resolving inflected forms to their lemma: one trie descent against asking the forms table
+	static void formLookup(const std::string &filename, std::size_t lemmas = 50000)
+	{
+		std::vector<std::string> words {loadWords(filename, lemmas)};
+		if (words.empty()) return;
+
+		// every lemma with a plural and a participle, some of them lemmas already
+		Database db {":memory:"};
+		db.createTables();
+		db.beginTransaction();
+		for (const auto &lemma : words) db.insertWord(lemma);
+		std::vector<std::pair<std::string, int>> forms;
+		for (const auto &lemma : words)
+		{
+			int word_id {db.getWordID(lemma)};
+			for (const char *suffix : {"s", "ing"})
+			{
+				forms.emplace_back(lemma + suffix, word_id);
+				db.insertForm(word_id, forms.back().first, suffix[0] == 's' ? "plural" : "present participle");
+			}
+		}
+		db.commit();
+
+		Trie trie;
+		{
+			Trie::Loader loader {trie};
+			for (std::size_t i{0}; i < words.size(); ++i) loader.add(words[i], db.getWordID(words[i]));
+		}
+		std::cout << "--- " << forms.size() << " forms of " << words.size() << " lemmas ---\nlemmas only:\n";
+		trie.memoryReport(std::cout);
+		std::size_t added {Dictionary::loadForms(db, trie)};
+		std::cout << "with " << added << " forms (the rest are spelled like a lemma):\n";
+		trie.memoryReport(std::cout);
+
+		auto start {std::chrono::steady_clock::now()};
+		std::size_t resolved {0};
+		for (int r{0}; r < 10; ++r) for (const auto &form : forms) resolved += trie.findID(form.first) >= 0;
+		std::chrono::duration<double, std::nano> descent {std::chrono::steady_clock::now() - start};
+
+		// the query the trie replaces (the schema only indexes forms by word_id)
+		Database::Statement stmt {db.prepare("SELECT word_id FROM forms WHERE form = ?;")};
+		std::size_t queries {std::min<std::size_t>(forms.size(), 200)}, found {0};
+		start = std::chrono::steady_clock::now();
+		for (std::size_t i{0}; i < queries; ++i)
+		{
+			const std::string &form {forms[i * forms.size() / queries].first};
+			sqlite3_bind_text(stmt.get(), 1, form.c_str(), -1, SQLITE_STATIC);
+			if (sqlite3_step(stmt.get()) == SQLITE_ROW) ++found;
+			sqlite3_reset(stmt.get());
+		}
+		std::chrono::duration<double, std::nano> query {std::chrono::steady_clock::now() - start};
+
+		std::cout << "trie: " << descent.count() / (10 * forms.size()) << " ns/form (" << resolved / 10 << " resolved)\n"
+			<< "sql:  " << query.count() / queries << " ns/form (" << found << "/" << queries << " found)\n";
+	}
+
+	// hydrated entries under a skewed lookup stream with one-off scans mixed in: hit rate of plain LRU
+	// against TinyLFU admission at the same byte budget, and what a hit saves over the query
+	static void wordCache(const std::string &filename, std::size_t lemmas = 20000, std::size_t lookups = 200000)
+	{
+		std::vector<std::string> words {loadWords(filename, lemmas)};
+		if (words.empty()) return;
+
+		// every lemma with an etymology, two forms and two senses with examples, synonyms and an antonym
+		Database db {":memory:"};
+		db.createTables();
+		db.beginTransaction();
+		std::vector<int> ids;
+		for (const auto &lemma : words)
+		{
+			db.insertWord(lemma);
+			int word_id {db.getWordID(lemma)};
+			ids.push_back(word_id);
+			db.insertEtymology(word_id, {"From Middle English " + lemma + ", from Old English."});
+			db.insertForm(word_id, lemma + "s", "plural");
+			db.insertForm(word_id, lemma + "ed", "past");
+			for (int s{0}; s < 2; ++s)
+			{
+				int sense_id {db.insertSense(word_id, s ? "verb" : "noun", "A definition of " + lemma + " that runs to a sentence or so of text.")};
+				db.insertExample(sense_id, "An example sentence using " + lemma + " in context.");
+				db.insertExample(sense_id, "Another, longer example sentence that uses " + lemma + " again.");
+				db.insertSynonym(sense_id, lemma + "like");
+				db.insertSynonym(sense_id, "quasi" + lemma);
+				db.insertAntonym(sense_id, "non" + lemma);
+			}
+		}
+		db.commit();
+
+		// Zipf over a shuffled order, with a scan of 2000 words nobody asks for twice every 20000 lookups
+		std::vector<int> stream;
+		dct::XorShift next;
+		std::vector<std::size_t> order(ids.size());
+		for (std::size_t i{0}; i < order.size(); ++i) order[i] = i;
+		for (std::size_t i{order.size() - 1}; i > 0; --i) std::swap(order[i], order[next() % (i + 1)]);
+		std::size_t scanned {0};
+		while (stream.size() < lookups)
+		{
+			if (stream.size() % 20000 == 19999)
+			{
+				for (int k{0}; k < 2000; ++k) stream.push_back(ids[order[ids.size() - 1 - (scanned++ % (ids.size() / 2))]]);
+				continue;
+			}
+			double u {static_cast<double>(next() % 1000000 + 1) / 1000000};
+			std::size_t rank {static_cast<std::size_t>(std::pow(static_cast<double>(ids.size()), u)) - 1};
+			stream.push_back(ids[order[rank]]);
+		}
+
+		WordInfo sample;
+		db.fetchEntry(ids[0], sample);
+		std::size_t entryBytes {WordCache::bytes(sample)};
+		std::size_t capacity {ids.size() / 20 * entryBytes}; // room for about 5% of the words
+
+		std::cout << "--- " << stream.size() << " lookups over " << ids.size() << " entries (~" << entryBytes 
+			<< " bytes each, cache " << capacity << " bytes) ---\n";
+		for (bool admission : {false, true})
+		{
+			WordCache cache {capacity, admission};
+			std::size_t found {0};
+			auto start {std::chrono::steady_clock::now()};
+			for (int word_id : stream)
+			{
+				std::shared_ptr<const WordInfo> info {cache.find(word_id)};
+				if (!info)
+				{
+					WordInfo fetched;
+					if (db.fetchEntry(word_id, fetched)) info = cache.insert(word_id, std::move(fetched));
+				}
+				found += info && info->senses.size() == 2;
+			}
+			std::chrono::duration<double, std::micro> elapsed {std::chrono::steady_clock::now() - start};
+
+			std::cout << (admission ? "TinyLFU: " : "LRU:     ") << elapsed.count() / stream.size() << " us/lookup (" << found << " complete)\n";
+			cache.memoryReport(std::cout);
+		}
+
+		// a hit against a miss, on their own
+		WordCache cache {capacity};
+		WordInfo fetched;
+		db.fetchEntry(ids[0], fetched);
+		cache.insert(ids[0], std::move(fetched));
+		auto start {std::chrono::steady_clock::now()};
+		for (int r{0}; r < 10000; ++r) cache.find(ids[0]);
+		std::chrono::duration<double, std::nano> hit {std::chrono::steady_clock::now() - start};
+		start = std::chrono::steady_clock::now();
+		for (int r{0}; r < 1000; ++r) db.fetchEntry(ids[r % ids.size()], fetched);
+		std::chrono::duration<double, std::nano> query {std::chrono::steady_clock::now() - start};
+		std::cout << "hit: " << hit.count() / 10000 << " ns, query: " << query.count() / 1000 << " ns\n";
+	}
+
+	// entry hydration against a database filled by an import: p50/p99 of Database::fetchEntry (into a fresh
+	// WordInfo, and into one reused across calls) next to a query per table and per sense
+	static void entryFetch(const std::string &filename, std::size_t samples = 20000)
+	{
+		Database db {filename};
+		std::vector<int> ids;
+		{
+			Database::Statement stmt {db.prepare("SELECT id FROM words;")};
+			while (stmt && sqlite3_step(stmt.get()) == SQLITE_ROW) ids.push_back(sqlite3_column_int(stmt.get(), 0));
+		}
+		if (ids.empty()) return;
+
+		dct::XorShift next;
+		for (std::size_t i{ids.size() - 1}; i > 0; --i) std::swap(ids[i], ids[next() % (i + 1)]);
+		if (ids.size() > samples) ids.resize(samples);
+
+		auto text {[](sqlite3_stmt *stmt, int column)
+		{
+			const unsigned char *value {sqlite3_column_text(stmt, column)};
+			return value ? std::string{reinterpret_cast<const char *>(value)} : std::string{};
+		}};
+		auto column {[&db, &text](const char *sql, int id, std::vector<std::string> &out)
+		{
+			Database::Statement stmt {db.prepare(sql)};
+			sqlite3_bind_int(stmt.get(), 1, id);
+			while (sqlite3_step(stmt.get()) == SQLITE_ROW) out.push_back(text(stmt.get(), 0));
+		}};
+		auto roundTrips {[&db, &text, &column](int word_id, WordInfo &out)
+		{
+			out = WordInfo{};
+			{
+				Database::Statement stmt {db.prepare("SELECT lemma FROM words WHERE id = ?;")};
+				sqlite3_bind_int(stmt.get(), 1, word_id);
+				if (sqlite3_step(stmt.get()) != SQLITE_ROW) return false;
+				out.id = word_id;
+				out.lemma = text(stmt.get(), 0);
+			}
+			column("SELECT etymology FROM etymologys WHERE word_id = ? ORDER BY id;", word_id, out.etymology);
+			{
+				Database::Statement stmt {db.prepare("SELECT form, tag FROM forms WHERE word_id = ? ORDER BY id;")};
+				sqlite3_bind_int(stmt.get(), 1, word_id);
+				while (sqlite3_step(stmt.get()) == SQLITE_ROW) out.forms.push_back({text(stmt.get(), 0), text(stmt.get(), 1)});
+			}
+			std::vector<int> senseIDs;
+			{
+				Database::Statement stmt {db.prepare("SELECT id, pos, definition FROM senses WHERE word_id = ? ORDER BY id;")};
+				sqlite3_bind_int(stmt.get(), 1, word_id);
+				while (sqlite3_step(stmt.get()) == SQLITE_ROW)
+				{
+					senseIDs.push_back(sqlite3_column_int(stmt.get(), 0));
+					out.senses.push_back({text(stmt.get(), 1), text(stmt.get(), 2), {}, {}, {}});
+				}
+			}
+			for (std::size_t i{0}; i < senseIDs.size(); ++i)
+			{
+				column("SELECT example FROM examples WHERE sense_id = ? ORDER BY id;", senseIDs[i], out.senses[i].examples);
+				column("SELECT synonym FROM synonyms WHERE sense_id = ? ORDER BY id;", senseIDs[i], out.senses[i].synonyms);
+				column("SELECT antonyms FROM antonyms WHERE sense_id = ? ORDER BY id;", senseIDs[i], out.senses[i].antonyms);
+			}
+			return true;
+		}};
+
+		// the two paths have to agree before their timings mean anything
+		auto same {[](const WordInfo &a, const WordInfo &b)
+		{
+			if (a.id != b.id || a.lemma != b.lemma || a.etymology != b.etymology || a.forms.size() != b.forms.size()
+				|| a.senses.size() != b.senses.size()) return false;
+			for (std::size_t i{0}; i < a.forms.size(); ++i)
+				if (a.forms[i].form != b.forms[i].form || a.forms[i].tag != b.forms[i].tag) return false;
+			for (std::size_t i{0}; i < a.senses.size(); ++i)
+			{
+				const WordInfo::Sense &x {a.senses[i]}, &y {b.senses[i]};
+				if (x.pos != y.pos || x.definition != y.definition || x.examples != y.examples 
+					|| x.synonyms != y.synonyms || x.antonyms != y.antonyms) return false;
+			}
+			return true;
+		}};
+		std::size_t mismatches {0}, rows {0};
+		WordInfo reused, expected;
+		for (int word_id : ids)
+		{
+			roundTrips(word_id, expected);
+			db.fetchEntry(word_id, reused);
+			mismatches += !same(expected, reused);
+			rows += 1 + expected.etymology.size() + expected.forms.size() + expected.senses.size();
+			for (const auto &sense : expected.senses) rows += sense.examples.size() + sense.synonyms.size() + sense.antonyms.size();
+		}
+		std::cout << "--- " << ids.size() << " entries from " << filename << " (" << static_cast<double>(rows) / ids.size() 
+			<< " rows each, " << mismatches << " mismatches) ---\n";
+
+		auto report {[&ids](const char *label, auto fetch)
+		{
+			std::vector<double> times;
+			times.reserve(ids.size());
+			for (int word_id : ids)
+			{
+				auto start {std::chrono::steady_clock::now()};
+				fetch(word_id);
+				times.push_back(std::chrono::duration<double, std::micro>{std::chrono::steady_clock::now() - start}.count());
+			}
+			std::sort(times.begin(), times.end());
+			std::cout << label << "p50 " << times[times.size() / 2] << " us, p99 " << times[times.size() * 99 / 100] << " us\n";
+		}};
+		report("per table:     ", [&](int word_id) { WordInfo info; roundTrips(word_id, info); });
+		report("fetch:         ", [&](int word_id) { WordInfo info; db.fetchEntry(word_id, info); });
+		report("fetch, reused: ", [&](int word_id) { db.fetchEntry(word_id, reused); });
+	}
+
+	// a generated document: vocabulary words picked from the list by a fixed shuffle, each drawn
+	// with probability about 1/rank (Zipf), with punctuation, capitals and 3% typos
+	static std::string corpus(const std::vector<std::string> &words, std::size_t vocabulary, std::size_t megabytes)
+	{
+		dct::XorShift next;
+		std::string text;
+		text.reserve(megabytes << 20);
+		bool sentenceStart {true};
+		while (text.size() < (megabytes << 20))
+		{
+			double u {static_cast<double>(next() % 1000000 + 1) / 1000000};
+			std::size_t rank {static_cast<std::size_t>(std::pow(static_cast<double>(vocabulary), u)) - 1};
+			std::string token {words[(rank * 2654435761u) % words.size()]};
+			if (next() % 100 < 3) token[next() % token.size()] = static_cast<char>('a' + next() % dct::g_alpha); // typo
+			if (sentenceStart) token[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(token[0])));
+			text += token;
+
+			std::uint64_t p {next() % 100};
+			sentenceStart = p < 6;
+			text += p < 6 ? ". " : p < 12 ? ", " : p < 13 ? "; " : p < 14 ? " (12) " : " ";
+		}
+		return text;
+	}
+
+	// whole document checking in MB/s over a generated corpus (Zipf word mix, punctuation, a few typos)
+	static void documentThroughput(const std::string &filename, std::size_t megabytes = 32)
+	{
+		std::vector<std::string> words {loadWords(filename)};
+		if (words.empty()) return;
+
+		Dictionary dict;
+		dict.m_trie.clear();
+		loadTrie(dict.m_trie, words);
+		SpellChecker checker {dict};
+
+		// the whole word list, then a vocabulary closer to one author's
+		for (std::size_t vocabulary : {words.size(), std::size_t{20000}})
+		{
+			std::string text {corpus(words, vocabulary, megabytes)};
+			checker.setFilter(false);
+
+			auto run {[&text](const char *label, auto &&checkAll)
+			{
+				auto start {std::chrono::steady_clock::now()};
+				std::size_t misses {checkAll()};
+				std::chrono::duration<double> elapsed {std::chrono::steady_clock::now() - start};
+				std::cout << label << text.size() / elapsed.count() / (1 << 20) << " MB/s (" << misses << " misspelled)\n";
+			}};
+
+			std::cout << "--- document check over " << (text.size() >> 20) << " MB, " << vocabulary << " word vocabulary ---\n";
+			run("per token: ", [&]()
+			{
+				// the obvious loop: a string per token, checked one at a time
+				std::size_t misses {0};
+				std::string token;
+				for (char c : text)
+				{
+					if (std::isalpha(static_cast<unsigned char>(c)) || c == '\'') { token.push_back(c); continue; }
+					if (!token.empty() && !checker.check(token)) ++misses;
+					token.clear();
+				}
+				return misses;
+			});
+			run("checkDocument: ", [&]() { return checker.checkDocument(text).size(); });
+			checker.setFilter(true);
+			run("checkDocument + filter: ", [&]() { return checker.checkDocument(text).size(); });
+
+			auto sample {checker.checkDocument(std::string_view{text}.substr(0, 4096), true)};
+			if (!sample.empty())
+			{
+				const auto &miss {sample.front()};
+				std::cout << "first: '" << text.substr(miss.m_offset, miss.m_length) << "' at " << miss.m_offset 
+					<< (miss.m_corrections.empty() ? "" : ", did you mean '" + miss.m_corrections.front() + "'") << '\n';
+			}
+		}
+	}
+
+	// checkDocument spread over work-stealing pools of growing size, against the single threaded call
+	static void parallelDocument(const std::string &filename, std::size_t megabytes = 64)
+	{
+		std::vector<std::string> words {loadWords(filename)};
+		if (words.empty()) return;
+
+		Dictionary dict;
+		dict.m_trie.clear();
+		loadTrie(dict.m_trie, words);
+		SpellChecker checker {dict};
+		checker.setFilter(true);
+		std::string text {corpus(words, 20000, megabytes)};
+
+		auto start {std::chrono::steady_clock::now()};
+		auto expected {checker.checkDocument(text)};
+		std::chrono::duration<double> serial {std::chrono::steady_clock::now() - start};
+
+		std::cout << "--- parallel document check over " << (text.size() >> 20) << " MB (" << std::thread::hardware_concurrency() << " cores) ---\n"
+			<< "serial: " << text.size() / serial.count() / (1 << 20) << " MB/s (" << expected.size() << " misspelled)\n";
+
+		for (unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u})
+		{
+			ThreadPool pool {threads};
+			start = std::chrono::steady_clock::now();
+			auto found {checker.checkDocument(text, pool)};
+			std::chrono::duration<double> elapsed {std::chrono::steady_clock::now() - start};
+
+			bool same {found.size() == expected.size()};
+			for (std::size_t i{0}; same && i < found.size(); ++i)
+			{
+				same = found[i].m_offset == expected[i].m_offset && found[i].m_length == expected[i].m_length;
+			}
+			std::cout << threads << " threads: " << text.size() / elapsed.count() / (1 << 20) << " MB/s, speedup " 
+				<< serial.count() / elapsed.count() << "x, " << pool.steals() << " steals" << (same ? "" : " (MISMATCH)") << '\n';
+		}
+	}
+
+	// readers looking words up while a writer adds and removes others: the snapshot trie against
+	// the arena trie behind a shared_mutex; no reader may ever miss a word that was never removed
+	static void liveUpdates(const std::string &filename, unsigned readers = 4, double seconds = 1.0)
+	{
+		std::vector<std::string> words {loadWords(filename)};
+		if (words.empty()) return;
+
+		Trie trie;
+		loadTrie(trie, words);
+		std::vector<Trie::WordEntry> entries;
+		trie.collectEntries(entries);
+		ConcurrentTrie live;
+		live.build(entries);
+		std::shared_mutex lock;
+
+		// words that are in neither list: "qx" then the number in letters
+		auto synthetic {[](std::size_t n)
+		{
+			std::string w {"qx"};
+			do { w.push_back(static_cast<char>('a' + n % dct::g_alpha)); n /= dct::g_alpha; } while (n);
+			return w;
+		}};
+
+		auto run {[&](bool writing, auto &&contains, auto &&insert, auto &&remove)
+		{
+			std::atomic<bool> stop {false};
+			std::atomic<std::size_t> reads {0}, lost {0};
+			std::size_t writes {0};
+
+			std::vector<std::thread> threads;
+			for (unsigned r{0}; r < readers; ++r)
+			{
+				threads.emplace_back([&, r]()
+				{
+					std::size_t done {0}, missed {0};
+					for (std::size_t i {r * 7919}; !stop.load(std::memory_order_relaxed); ++i, ++done)
+					{
+						if (!contains(words[i % words.size()])) ++missed;
+					}
+					reads += done;
+					lost += missed;
+				});
+			}
+
+			auto start {std::chrono::steady_clock::now()};
+			while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds)
+			{
+				if (!writing) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); continue; }
+
+				// keep about a thousand synthetic words in, adding one and dropping the oldest
+				insert(synthetic(writes));
+				if (writes >= 1000) remove(synthetic(writes - 1000));
+				++writes;
+			}
+			stop = true;
+			for (auto &thread : threads) thread.join();
+			for (std::size_t n {writes > 1000 ? writes - 1000 : 0}; n < writes; ++n) remove(synthetic(n));
+
+			std::chrono::duration<double> elapsed {std::chrono::steady_clock::now() - start};
+			return std::make_tuple(reads.load() / elapsed.count(), writes / elapsed.count(), lost.load());
+		}};
+
+		auto liveContains {[&live](const std::string &w) { return live.contains(w); }};
+		auto liveInsert {[&live](const std::string &w) { live.insert(w, -1); }};
+		auto liveRemove {[&live](const std::string &w) { live.remove(w); }};
+		auto lockedContains {[&](const std::string &w) { std::shared_lock<std::shared_mutex> guard {lock}; return trie.contains(w); }};
+		auto lockedInsert {[&](const std::string &w) { std::unique_lock<std::shared_mutex> guard {lock}; trie.insert(w, -1); }};
+		auto lockedRemove {[&](const std::string &w) { std::unique_lock<std::shared_mutex> guard {lock}; trie.remove(w); }};
+
+		std::cout << "--- " << readers << " readers over " << words.size() << " words (" << std::thread::hardware_concurrency() << " cores) ---\n";
+		auto report {[](const char *name, const auto &result)
+		{
+			std::cout << name << ": " << std::get<0>(result) / 1e6 << " M reads/s, " << std::get<1>(result) << " writes/s"
+				<< (std::get<2>(result) ? ", LOST " + std::to_string(std::get<2>(result)) + " reads" : "") << '\n';
+		}};
+		report("snapshot, no writer", run(false, liveContains, liveInsert, liveRemove));
+		report("snapshot, writer   ", run(true, liveContains, liveInsert, liveRemove));
+		report("locked, no writer  ", run(false, lockedContains, lockedInsert, lockedRemove));
+		report("locked, writer     ", run(true, lockedContains, lockedInsert, lockedRemove));
+
+		// every synthetic word is gone again, and nothing the writer replaced is still waiting on a reader
+		live.insert(synthetic(0), -1);
+		live.remove(synthetic(0));
+		ConcurrentTrie::Stats stats {live.stats()};
+		std::cout << "snapshot words: " << stats.m_words << " (" << (stats.m_words == words.size() ? "as built" : "MISMATCH") << "), "
+			<< stats.m_retired << " nodes still retired\n";
+		live.memoryReport(std::cout);
+	}
+
+	// time from construction to the first answered queries (maps the trie image when it is current)
+	static void startup()
+	{
+		auto start {std::chrono::steady_clock::now()};
+
+		Dictionary dict;
+		bool found {dict.search("the")};
+		std::vector<std::string> results;
+		dict.suggestFromPrefix("th", results, dct::g_maxSuggest);
+
+		std::chrono::duration<double, std::milli> elapsed {std::chrono::steady_clock::now() - start};
+		std::cout << "startup: " << elapsed.count() << " ms (" 
+			<< (dict.m_trie.isMapped() ? "mapped image" : "rebuilt from database") << ", found: " << found << ")\n";
+	}
 };
 
 int main()
@@ -45,6 +1134,81 @@ int main()
 	dict.print();
 #endif
 
+#if 0
+	// memory footprint of the trie layout
+	Tester::trieMemory(dct::g_dictTxt);
+	Tester::dawgBuild(dct::g_dictTxt);
+#endif
+
+#if 0
+	// cold start against dictionary.db / dictionary.trie
+	Tester::startup();
+	Tester::buildTrieTime();
+#endif
+
+#if 0
+	// trie built as per-letter shards in parallel, and one letter reloaded
+	Tester::shardedBuild(dct::g_dictTxt);
+#endif
+
+#if 0
+	// JSONL parse throughput (point at a Wiktextract dump)
+	Tester::ingestion("kaikki.org-dictionary-English.jsonl");
+#endif
+
+#if 0
+	// entry hydration latency (once a Wiktextract dump is imported)
+	Tester::entryFetch(dct::g_dictDb);
+#endif
+
+#if 0
+	// frequency ranked autocomplete
+	Tester::rankedSuggest(dct::g_dictTxt);
+	Tester::autofillLatency(dct::g_dictTxt);
+#endif
+
+#ifdef DCT_COUNT_ALLOCATIONS
+	// normalization on the query paths: heap allocations per lookup
+	Tester::lookupAllocations(dct::g_dictTxt);
+#endif
+
+#if 0
+	// Bloom filter in front of the trie for misspelled tokens
+	Tester::filterCheck(dct::g_dictTxt);
+#endif
+
+#if 0
+	// whole document checking throughput
+	Tester::documentThroughput(dct::g_dictTxt);
+#endif
+
+#if 0
+	// document checking split across the thread pool
+	Tester::parallelDocument(dct::g_dictTxt);
+#endif
+
+#if 0
+	// inflected forms resolved to their lemma through the trie
+	Tester::formLookup(dct::g_dictTxt);
+#endif
+
+#if 0
+	// hydrated entry cache, LRU against TinyLFU admission
+	Tester::wordCache(dct::g_dictTxt);
+#endif
+
+#if 0
+	// lock-free lookups during live updates
+	Tester::liveUpdates(dct::g_dictTxt);
+#endif
+
+#if 0
+	// edit distance search vs brute force
+	Tester::correctionLatency(dct::g_dictTxt);
+	Tester::correctionEngines(dct::g_dictTxt);
+	Tester::distanceKernels(dct::g_dictTxt);
+#endif
+
 #if 1
 	// spell checking / autofill
 	SpellChecker checker(dict);
@@ -54,6 +1218,13 @@ int main()
 
 	std::cout << "\n--- suggestions for " << "'" << input << "'" << " ---" << std::endl;
 	checker.printSuggest(checker.suggest(input));
+	std::cout << "autofill: " << checker.autofill(input) << std::endl;
+
+	if (!checker.check(input))
+	{
+		std::cout << "\n--- did you mean ---" << std::endl;
+		checker.printSuggest(checker.correct(input));
+	}
 	dict.dumpWord(input);
 #endif
 
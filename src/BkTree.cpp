@@ -0,0 +1,158 @@
+#include "BkTree.h"
+#include "EditDistance.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+BkTree::BkTree() { clear(); }
+
+void BkTree::build(const std::vector<std::string> &words)
+{
+	clear();
+	if (words.empty()) return;
+
+	// distances longer than a node can record would break the layout
+	constexpr int maxEdge {std::numeric_limits<std::uint8_t>::max()};
+
+	// grow the tree with one node per word first: children[w] = (distance, word) pairs under word w
+	std::vector<std::vector<std::pair<std::uint8_t, std::uint32_t>>> children;
+	children.reserve(words.size());
+
+	for (const auto &word : words)
+	{
+		if (word.size() > maxEdge) continue;
+
+		auto index {static_cast<std::uint32_t>(m_offsets.size() - 1)};
+		m_text += word;
+		m_offsets.push_back(static_cast<std::uint32_t>(m_text.size()));
+		children.emplace_back();
+		if (index == 0) continue; // first word is the root
+
+		std::uint32_t node {0};
+		while (true)
+		{
+			auto distance {static_cast<std::uint8_t>(dct::damerauLevenshtein(word, wordAt(node)))};
+			if (distance == 0) break; // duplicate, keeps its slot in m_offsets but joins no node
+
+			auto &edges {children[node]};
+			auto it {std::find_if(edges.begin(), edges.end(), [distance](const auto &edge) { return edge.first == distance; })};
+			if (it == edges.end())
+			{
+				edges.emplace_back(distance, index);
+				break;
+			}
+			node = it->second;
+		}
+	}
+
+	// flatten breadth first: each node's children land in one sorted block
+	m_nodes.reserve(m_offsets.size() - 1);
+	m_nodes.push_back(BkNode{});
+
+	for (std::size_t i{0}; i < m_nodes.size(); ++i)
+	{
+		auto &edges {children[m_nodes[i].m_word]};
+		std::sort(edges.begin(), edges.end());
+
+		m_nodes[i].m_children = static_cast<std::uint32_t>(m_nodes.size());
+		m_nodes[i].m_childCount = static_cast<std::uint16_t>(edges.size());
+		if (!edges.empty()) m_nodes[i].m_maxChild = edges.back().first;
+
+		for (const auto &[distance, word] : edges)
+		{
+			BkNode child;
+			child.m_word = word;
+			child.m_distance = distance;
+			m_nodes.push_back(child);
+		}
+		std::vector<std::pair<std::uint8_t, std::uint32_t>>().swap(edges); // free as we go
+	}
+
+	m_text.shrink_to_fit();
+	m_nodes.shrink_to_fit();
+}
+
+bool BkTree::loadFile(const std::string &filename)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		std::cerr << "Error: could not open " << filename << '\n';
+		return false;
+	}
+
+	std::vector<std::string> words;
+	std::string word;
+	while (std::getline(file, word))
+	{
+		if (!word.empty() && word.back() == '\r') word.pop_back();
+		if (!word.empty()) words.push_back(word);
+	}
+
+	build(words);
+	return true;
+}
+
+void BkTree::clear()
+{
+	m_text.clear();
+	m_offsets.assign(1, 0);
+	m_nodes.clear();
+}
+
+void BkTree::lookup(std::string_view word, int maxDistance, std::vector<std::pair<std::string, int>> &out) const
+{
+	if (isEmpty() || word.empty()) return;
+
+	dct::EditPattern pattern {word};
+	std::vector<std::uint32_t> pending {0};
+	while (!pending.empty())
+	{
+		const BkNode &node {m_nodes[pending.back()]};
+		pending.pop_back();
+
+		// past maxChild + maxDistance no child can qualify either, so the exact distance doesn't matter
+		std::string_view candidate {wordAt(node.m_word)};
+		int distance {dct::damerauLevenshtein(word, candidate, std::max<int>(maxDistance, node.m_maxChild + maxDistance))};
+
+		if (distance <= maxDistance)
+		{
+			int osa {pattern.distance(candidate, maxDistance)};
+			if (osa <= maxDistance) out.emplace_back(candidate, osa);
+		}
+
+		// visit the children at distance - maxDistance ... distance + maxDistance
+		auto first {m_nodes.begin() + node.m_children};
+		auto last {first + node.m_childCount};
+		first = std::lower_bound(first, last, distance - maxDistance, [](const BkNode &child, int bound) { return child.m_distance < bound; });
+
+		for (; first != last && first->m_distance <= distance + maxDistance; ++first)
+		{
+			pending.push_back(static_cast<std::uint32_t>(first - m_nodes.begin()));
+		}
+	}
+}
+
+bool BkTree::isEmpty() const { return m_nodes.empty(); }
+
+std::size_t BkTree::size() const { return m_nodes.size(); }
+
+void BkTree::memoryReport(std::ostream &out) const
+{
+	std::size_t words {size()};
+	std::size_t bytes {m_text.capacity() + m_offsets.capacity() * sizeof(std::uint32_t) + m_nodes.capacity() * sizeof(BkNode)};
+
+	out << "words: " << words << '\n'
+		<< "bktree: " << bytes << " bytes";
+	if (words) out << " (" << static_cast<double>(bytes) / words << " bytes/word)";
+	out << '\n';
+}
+
+/*********************************
+// BkTree Helper Functions
+*********************************/
+std::string_view BkTree::wordAt(std::uint32_t index) const
+{
+	return std::string_view{m_text}.substr(m_offsets[index], m_offsets[index + 1] - m_offsets[index]);
+}
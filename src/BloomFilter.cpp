@@ -0,0 +1,114 @@
+#include "BloomFilter.h"
+#include "Normalize.h"
+
+namespace
+{
+	// odd multipliers that spread one 32-bit hash into a different bit per lane
+	constexpr std::uint32_t g_salts[8] {0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+		0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u};
+}
+
+BloomFilter::BloomFilter(std::size_t bitsPerWord) : m_bitsPerWord{bitsPerWord ? bitsPerWord : 1} {}
+
+void BloomFilter::build(const std::vector<std::string> &words)
+{
+	clear();
+	if (words.empty()) return;
+
+	std::size_t blockBits {m_lanes * 64};
+	m_blocks.assign((words.size() * m_bitsPerWord + blockBits - 1) / blockBits, Block{});
+
+	for (const auto &word : words)
+	{
+		std::uint64_t h {hash(word)};
+		Block &block {m_blocks[blockIndex(h)]};
+		for (int lane{0}; lane < m_lanes; ++lane) block.m_bits[lane] |= laneBit(h, lane);
+	}
+	m_count = words.size();
+}
+
+void BloomFilter::clear()
+{
+	m_blocks.clear();
+	m_blocks.shrink_to_fit();
+	m_count = 0;
+}
+
+bool BloomFilter::mayContain(std::string_view word) const
+{
+	if (m_blocks.empty()) return true; // nothing built, nothing ruled out
+
+	std::uint64_t h {hash(word)};
+	const Block &block {m_blocks[blockIndex(h)]};
+
+	// no early exit: the line is already loaded, eight branch free tests are cheaper than mispredicts
+	std::uint64_t missing {0};
+	for (int lane{0}; lane < m_lanes; ++lane) missing |= laneBit(h, lane) & ~block.m_bits[lane];
+	return missing == 0;
+}
+
+bool BloomFilter::isEmpty() const { return m_blocks.empty(); }
+
+std::size_t BloomFilter::size() const { return m_count; }
+
+std::size_t BloomFilter::memory() const { return m_blocks.capacity() * sizeof(Block); }
+
+double BloomFilter::expectedFalsePositiveRate() const
+{
+	if (m_blocks.empty()) return 1.0;
+
+	// an absent word passes when its bit is set in every lane of its block
+	double total {0};
+	for (const Block &block : m_blocks)
+	{
+		double pass {1};
+		for (int lane{0}; lane < m_lanes; ++lane) pass *= __builtin_popcountll(block.m_bits[lane]) / 64.0;
+		total += pass;
+	}
+	return total / m_blocks.size();
+}
+
+void BloomFilter::memoryReport(std::ostream &out) const
+{
+	std::size_t bytes {memory()};
+
+	out << "words: " << m_count << " (" << m_bitsPerWord << " bits/word, " << m_blocks.size() << " blocks)\n"
+		<< "bloom filter: " << bytes << " bytes";
+	if (m_count) out << " (" << static_cast<double>(bytes) / m_count << " bytes/word)";
+	out << "\nexpected false positives: " << expectedFalsePositiveRate() * 100 << "%\n";
+}
+
+/*********************************
+// BloomFilter Helper Functions
+*********************************/
+std::size_t BloomFilter::blockIndex(std::uint64_t hash) const
+{
+	// top 32 bits scaled onto the block count (no modulo)
+	return static_cast<std::size_t>(((hash >> 32) * m_blocks.size()) >> 32);
+}
+
+std::uint64_t BloomFilter::hash(std::string_view word)
+{
+	// FNV-1a over the normalized letters, then a murmur finalizer so both halves are usable
+	std::uint64_t h {14695981039346656037ull};
+	for (char c : word)
+	{
+		int index {dct::letterIndex(c)};
+		if (index < 0) continue;
+		h = (h ^ static_cast<std::uint64_t>('a' + index)) * 1099511628211ull;
+	}
+
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return h;
+}
+
+std::uint64_t BloomFilter::laneBit(std::uint64_t hash, int lane)
+{
+	// top 6 bits of the salted low half pick the bit within the lane
+	std::uint32_t mixed {static_cast<std::uint32_t>(hash) * g_salts[lane]};
+	return 1ull << (mixed >> 26);
+}
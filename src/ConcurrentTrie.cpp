@@ -0,0 +1,418 @@
+#include "ConcurrentTrie.h"
+#include "Normalize.h"
+#include <algorithm>
+#include <thread>
+#include <functional>
+#include <new>
+
+namespace
+{
+	// where this thread last found a free reader slot, so it usually gets the same one back
+	thread_local std::size_t t_readerHint {std::hash<std::thread::id>{}(std::this_thread::get_id())};
+}
+
+ConcurrentTrie::ConcurrentTrie() { m_root.store(makeNode(nullptr, 0)); }
+
+ConcurrentTrie::~ConcurrentTrie()
+{
+	std::vector<const Node *> nodes;
+	collectSubtree(m_root.load(), nodes);
+	for (const Node *node : nodes) freeNode(node);
+	for (const auto &retired : m_retired) freeNode(retired.second);
+}
+
+void ConcurrentTrie::build(const std::vector<Trie::WordEntry> &entries)
+{
+	std::lock_guard<std::mutex> lock {m_writeMutex};
+
+	const Node *root {buildRange(entries, 0, entries.size(), 0)};
+	std::vector<const Node *> replaced;
+	collectSubtree(m_root.load(std::memory_order_relaxed), replaced);
+
+	m_count = entries.size();
+	publish(root, replaced);
+}
+
+bool ConcurrentTrie::insert(std::string_view word, int word_id, std::uint32_t score) { return insert(word, word_id, score, false); }
+
+bool ConcurrentTrie::insertForm(std::string_view form, int lemma_id, std::uint32_t score) { return insert(form, lemma_id, score, true); }
+
+bool ConcurrentTrie::remove(std::string_view word)
+{
+	std::lock_guard<std::mutex> lock {m_writeMutex};
+
+	std::vector<const Node *> path(word.size() + 1, nullptr);
+	path[0] = m_root.load(std::memory_order_relaxed);
+	for (std::size_t i{0}; i < word.size(); ++i)
+	{
+		int index {word[i] - 'a'};
+		if (index < 0 || index >= dct::g_alpha) return false;
+		path[i + 1] = child(path[i], index);
+		if (!path[i + 1]) return false; // not found
+	}
+
+	const Node *leaf {path[word.size()]};
+	if (!leaf->m_isEndOfWord) return false;
+
+	// the last node loses its word (and goes, if nothing hangs below it)
+	const Node *below {nullptr};
+	if (leaf->childCount() > 0 || word.empty())
+	{
+		Node *unmarked {makeNode(leaf, leaf->childCount())};
+		std::copy(leaf->children(), leaf->children() + leaf->childCount(), unmarked->children());
+		unmarked->m_isEndOfWord = false;
+		unmarked->m_isForm = false;
+		unmarked->m_wordID = -1;
+		unmarked->m_score = 0;
+		unmarked->m_maxScore = maxScore(unmarked);
+		below = unmarked;
+	}
+
+	// nodes left with no word and no children go too, except the root
+	for (std::size_t d{word.size()}; d-- > 0;)
+	{
+		const Node *old {path[d]};
+		if (!below && d > 0 && old->childCount() == 1 && !old->m_isEndOfWord) continue;
+		below = withChild(old, word[d] - 'a', below);
+	}
+
+	std::vector<const Node *> replaced(path.begin(), path.end());
+	--m_count;
+	publish(below, replaced);
+	return true;
+}
+
+bool ConcurrentTrie::contains(std::string_view word) const
+{
+	ReadGuard guard {*this};
+	const Node *node {guard.root()};
+
+	for (char c : word)
+	{
+		int index {dct::letterIndex(c)};
+		if (index < 0) continue;
+
+		node = child(node, index);
+		if (!node) return false; // not found
+	}
+	return node->m_isEndOfWord;
+}
+
+int ConcurrentTrie::findID(std::string_view word) const
+{
+	ReadGuard guard {*this};
+	const Node *node {guard.root()};
+
+	for (char c : word)
+	{
+		int index {dct::letterIndex(c)};
+		if (index < 0) continue;
+
+		node = child(node, index);
+		if (!node) return -1; // not found
+	}
+	return node->m_isEndOfWord ? node->m_wordID : -1;
+}
+
+void ConcurrentTrie::collectWithPrefix(std::string_view prefix, std::vector<std::string> &out, std::size_t limit, bool withPrefix) const
+{
+	ReadGuard guard {*this};
+	const Node *node {guard.root()};
+	std::string currentWord;
+
+	for (char c : prefix)
+	{
+		int index {dct::letterIndex(c)};
+		if (index < 0) continue;
+
+		node = child(node, index);
+		if (!node) return; // prefix not found
+		currentWord.push_back(static_cast<char>('a' + index));
+	}
+
+	// best first, ordered like Trie::collectBest (higher score, then alphabetical, a word before its subtree)
+	struct Entry
+	{
+		const Node *m_node;
+		bool m_isWord;
+		std::string m_word;
+	};
+	std::vector<Entry> entries;
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> queue; // (score, entry)
+
+	auto later = [&entries](const auto &a, const auto &b)
+	{
+		if (a.first != b.first) return a.first < b.first;
+		const Entry &x {entries[a.second]}, &y {entries[b.second]};
+		if (x.m_word != y.m_word) return x.m_word > y.m_word;
+		return !x.m_isWord && y.m_isWord;
+	};
+	auto push = [&](std::uint32_t score, Entry entry)
+	{
+		queue.emplace_back(score, static_cast<std::uint32_t>(entries.size()));
+		entries.push_back(std::move(entry));
+		std::push_heap(queue.begin(), queue.end(), later);
+	};
+	const Node *start {node};
+	push(node->m_maxScore, Entry{node, false, std::move(currentWord)});
+
+	while (!queue.empty() && out.size() < limit)
+	{
+		std::pop_heap(queue.begin(), queue.end(), later);
+		Entry &top {entries[queue.back().second]};
+		queue.pop_back();
+
+		if (top.m_isWord)
+		{
+			out.push_back(std::move(top.m_word));
+			continue;
+		}
+
+		const Node *n {top.m_node};
+		std::string topWord {std::move(top.m_word)}; // pushes below may reallocate entries
+		if (n->m_isEndOfWord && (withPrefix || n != start)) push(n->m_score, Entry{n, true, topWord});
+
+		int slot {0};
+		for (std::uint32_t mask {n->m_childMask}; mask; mask &= mask - 1, ++slot)
+		{
+			const Node *next {n->children()[slot]};
+			push(next->m_maxScore, Entry{next, false, topWord + static_cast<char>('a' + __builtin_ctz(mask))});
+		}
+	}
+}
+
+void ConcurrentTrie::collectEntries(std::vector<Trie::WordEntry> &out) const
+{
+	ReadGuard guard {*this};
+	std::string currentWord;
+	collectEntries(guard.root(), currentWord, out);
+}
+
+bool ConcurrentTrie::isEmpty() const { return size() == 0; }
+
+std::size_t ConcurrentTrie::size() const { return m_count.load(); }
+
+ConcurrentTrie::Stats ConcurrentTrie::stats() const
+{
+	std::lock_guard<std::mutex> lock {m_writeMutex};
+
+	Stats stats;
+	stats.m_words = m_count.load();
+	stats.m_epoch = m_epoch.load();
+	stats.m_writes = m_writes;
+	stats.m_copied = m_copied;
+	stats.m_retired = m_retired.size();
+	stats.m_reclaimed = m_reclaimed;
+	for (const ReaderSlot &slot : m_readers) stats.m_readers += slot.m_epoch.load() != 0;
+	return stats;
+}
+
+void ConcurrentTrie::memoryReport(std::ostream &out) const
+{
+	Stats s {stats()};
+	std::size_t bytes;
+	{
+		std::lock_guard<std::mutex> lock {m_writeMutex};
+		bytes = m_nodeBytes;
+	}
+
+	out << "words: " << s.m_words << " (" << s.m_writes << " writes, epoch " << s.m_epoch << ")\n"
+		<< "nodes: " << s.m_copied << " created, " << s.m_retired << " retired, " << s.m_reclaimed << " reclaimed\n"
+		<< "concurrent trie: " << bytes << " bytes";
+	if (s.m_words) out << " (" << static_cast<double>(bytes) / s.m_words << " bytes/word)";
+	out << '\n';
+}
+
+/*********************************
+// ConcurrentTrie Helper Functions
+*********************************/
+ConcurrentTrie::ReadGuard::ReadGuard(const ConcurrentTrie &trie) : m_trie{trie}, m_slot{t_readerHint % m_readerSlots}
+{
+	// announce the epoch before reading the root: a writer that then retires what this
+	// read can reach will see the announcement and keep those nodes
+	std::uint64_t epoch {trie.m_epoch.load()};
+	for (std::size_t tried{0};; ++tried)
+	{
+		std::uint64_t free {0};
+		if (trie.m_readers[m_slot].m_epoch.compare_exchange_strong(free, epoch)) break;
+
+		m_slot = (m_slot + 1) % m_readerSlots;
+		if (tried % m_readerSlots == m_readerSlots - 1) std::this_thread::yield(); // every slot busy
+	}
+	t_readerHint = m_slot;
+	m_root = trie.m_root.load();
+}
+
+ConcurrentTrie::ReadGuard::~ReadGuard() { m_trie.m_readers[m_slot].m_epoch.store(0, std::memory_order_release); }
+
+const ConcurrentTrie::Node *ConcurrentTrie::child(const Node *node, int index)
+{
+	if (!(node->m_childMask & (1u << index))) return nullptr;
+	return node->children()[node->slot(index)];
+}
+
+std::size_t ConcurrentTrie::nodeBytes(int childCount) { return sizeof(Node) + childCount * sizeof(const Node *); }
+
+ConcurrentTrie::Node *ConcurrentTrie::makeNode(const Node *from, int childCount)
+{
+	Node *node {new (::operator new(nodeBytes(childCount))) Node{}};
+	if (from)
+	{
+		node->m_childMask = from->m_childMask;
+		node->m_wordID = from->m_wordID;
+		node->m_score = from->m_score;
+		node->m_maxScore = from->m_maxScore;
+		node->m_isEndOfWord = from->m_isEndOfWord;
+		node->m_isForm = from->m_isForm;
+	}
+
+	m_nodeBytes += nodeBytes(childCount);
+	++m_copied;
+	return node;
+}
+
+void ConcurrentTrie::freeNode(const Node *node)
+{
+	m_nodeBytes -= nodeBytes(node->childCount());
+	::operator delete(const_cast<Node *>(node));
+}
+
+bool ConcurrentTrie::insert(std::string_view word, int word_id, std::uint32_t score, bool isForm)
+{
+	for (char c : word) if (c < 'a' || c > 'z') return false; // normalize() should have removed it
+
+	std::lock_guard<std::mutex> lock {m_writeMutex};
+
+	// the current path, as far as it goes (nullptr past the end)
+	std::vector<const Node *> path(word.size() + 1, nullptr);
+	path[0] = m_root.load(std::memory_order_relaxed);
+	for (std::size_t i{0}; i < word.size() && path[i]; ++i) path[i + 1] = child(path[i], word[i] - 'a');
+
+	// like Trie: a lemma is never replaced, and replaces a form stored under its spelling
+	const Node *leaf {path[word.size()]};
+	if (leaf && leaf->m_isEndOfWord && (isForm || !leaf->m_isForm)) return false;
+	bool promoted {leaf && leaf->m_isEndOfWord};
+
+	// copy the last node with the word marked, then every node above it with the new child swapped in
+	Node *marked {makeNode(leaf, leaf ? leaf->childCount() : 0)};
+	if (leaf) std::copy(leaf->children(), leaf->children() + leaf->childCount(), marked->children());
+	marked->m_isEndOfWord = true;
+	marked->m_isForm = isForm;
+	marked->m_wordID = word_id;
+	marked->m_score = score;
+	marked->m_maxScore = std::max(marked->m_maxScore, score);
+
+	const Node *below {marked};
+	for (std::size_t d{word.size()}; d-- > 0;) below = withChild(path[d], word[d] - 'a', below);
+
+	std::vector<const Node *> replaced;
+	for (const Node *node : path) if (node) replaced.push_back(node);
+	if (!promoted) ++m_count;
+	publish(below, replaced);
+	return true;
+}
+
+const ConcurrentTrie::Node *ConcurrentTrie::withChild(const Node *old, int index, const Node *replacement)
+{
+	// a copy of old (or a new node) whose child at index is replacement, or gone if that is nullptr
+	std::uint32_t bit {1u << index};
+	std::uint32_t mask {old ? old->m_childMask : 0};
+	mask = replacement ? mask | bit : mask & ~bit;
+
+	Node *node {makeNode(old, __builtin_popcount(mask))};
+	node->m_childMask = mask;
+
+	int slot {0};
+	for (std::uint32_t rest {mask}; rest; rest &= rest - 1, ++slot)
+	{
+		int letter {__builtin_ctz(rest)};
+		node->children()[slot] = letter == index ? replacement : old->children()[old->slot(letter)];
+	}
+	node->m_maxScore = maxScore(node);
+	return node;
+}
+
+std::uint32_t ConcurrentTrie::maxScore(const Node *node)
+{
+	std::uint32_t best {node->m_isEndOfWord ? node->m_score : 0};
+	for (int i{0}; i < node->childCount(); ++i) best = std::max(best, node->children()[i]->m_maxScore);
+	return best;
+}
+
+const ConcurrentTrie::Node *ConcurrentTrie::buildRange(const std::vector<Trie::WordEntry> &entries, std::size_t first, std::size_t last, std::size_t depth)
+{
+	// entries[first, last) share their first depth letters; one of them may end here
+	bool ends {first < last && entries[first].m_word.size() == depth};
+	std::size_t begin {first + ends};
+
+	std::uint32_t mask {0};
+	for (std::size_t i{begin}; i < last; ++i) mask |= 1u << (entries[i].m_word[depth] - 'a');
+
+	Node *node {makeNode(nullptr, __builtin_popcount(mask))};
+	node->m_childMask = mask;
+	if (ends)
+	{
+		node->m_isEndOfWord = true;
+		node->m_isForm = entries[first].m_isForm;
+		node->m_wordID = entries[first].m_wordID;
+		node->m_score = entries[first].m_score;
+	}
+
+	// one child per run of entries with the same next letter
+	int slot {0};
+	for (std::size_t i{begin}; i < last; ++slot)
+	{
+		std::size_t j {i};
+		while (j < last && entries[j].m_word[depth] == entries[i].m_word[depth]) ++j;
+		node->children()[slot] = buildRange(entries, i, j, depth + 1);
+		i = j;
+	}
+	node->m_maxScore = maxScore(node);
+	return node;
+}
+
+void ConcurrentTrie::publish(const Node *root, std::vector<const Node *> &replaced)
+{
+	m_root.store(root);
+	++m_writes;
+
+	// readers from before the store announced an epoch <= this one, later readers can't reach replaced
+	std::uint64_t epoch {m_epoch.fetch_add(1)};
+	for (const Node *node : replaced) m_retired.emplace_back(epoch, node);
+	reclaim();
+}
+
+void ConcurrentTrie::reclaim()
+{
+	// the oldest epoch a reader is still in; anything retired before it is unreachable
+	std::uint64_t oldest {UINT64_MAX};
+	for (const ReaderSlot &slot : m_readers)
+	{
+		std::uint64_t epoch {slot.m_epoch.load()};
+		if (epoch != 0 && epoch < oldest) oldest = epoch;
+	}
+
+	std::size_t freed {0};
+	while (freed < m_retired.size() && m_retired[freed].first < oldest) freeNode(m_retired[freed++].second);
+	m_retired.erase(m_retired.begin(), m_retired.begin() + freed);
+	m_reclaimed += freed;
+}
+
+void ConcurrentTrie::collectSubtree(const Node *node, std::vector<const Node *> &out) const
+{
+	out.push_back(node);
+	for (int i{0}; i < node->childCount(); ++i) collectSubtree(node->children()[i], out);
+}
+
+void ConcurrentTrie::collectEntries(const Node *node, std::string &currentWord, std::vector<Trie::WordEntry> &out) const
+{
+	if (node->m_isEndOfWord) out.push_back(Trie::WordEntry{currentWord, node->m_wordID, node->m_score, node->m_isForm});
+
+	int slot {0};
+	for (std::uint32_t mask {node->m_childMask}; mask; mask &= mask - 1, ++slot)
+	{
+		currentWord.push_back(static_cast<char>('a' + __builtin_ctz(mask)));
+		collectEntries(node->children()[slot], currentWord, out);
+		currentWord.pop_back();
+	}
+}
@@ -1,15 +1,74 @@
 #include "Database.h"
+#include "Utils.h"
+
+namespace
+{
+	// a text column straight into a string that may already have room for it (NULL reads as empty)
+	void assignText(std::string &to, sqlite3_stmt *stmt, int column)
+	{
+		const unsigned char *text {sqlite3_column_text(stmt, column)};
+		if (!text) to.clear();
+		else to.assign(reinterpret_cast<const char *>(text), static_cast<std::size_t>(sqlite3_column_bytes(stmt, column)));
+	}
+
+	// the next element to overwrite, appended once the old ones run out
+	template <typename T>
+	T &nextSlot(std::vector<T> &items, std::size_t &used)
+	{
+		if (used == items.size()) items.emplace_back();
+		return items[used++];
+	}
+}
 
 Database::Database(const std::string& filename) 
 { 
 	// open database
 	if (sqlite3_open(filename.c_str(), &db)) throw std::runtime_error("Error: Can't open database\n");
+
+	// reads come straight out of the mapped file, without a copy into SQLite's page cache first
+	std::string mmap {"PRAGMA mmap_size = " + std::to_string(dct::g_dbMapBytes) + ";"};
+	exec(mmap.c_str());
 }
 
-Database::~Database() { sqlite3_close(db); }
+Database::~Database() 
+{ 
+	// cached statements must be finalized before the connection can close
+	for (auto &[sql, stmt] : m_statements) sqlite3_finalize(stmt);
+	sqlite3_close(db); 
+}
+
+Database::Statement::~Statement()
+{
+	if (!m_stmt) return;
+	sqlite3_reset(m_stmt); // ready to step again
+	sqlite3_clear_bindings(m_stmt); // drop references to the caller's strings
+}
 
 sqlite3* Database::getDB() { return db; }
 
+Database::Statement Database::prepare(const char *sql)
+{
+	auto found {m_statements.find(sql)};
+	if (found != m_statements.end()) return Statement{found->second};
+
+	/* 
+	db → your open database
+	sql → the SQL string
+	-1 → read full string
+	&stmt → where to store the compiled statement
+	nullptr → ignore unused output
+	*/	
+	sqlite3_stmt *stmt {nullptr};
+	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+	{
+		sqlite3_finalize(stmt);
+		return Statement{nullptr};
+	}
+
+	m_statements.emplace(sqlite3_sql(stmt), stmt); // lookups by query text don't allocate
+	return Statement{stmt};
+}
+
 void Database::createTables() 
 {
 	/*
@@ -68,23 +127,85 @@ void Database::createTables()
         "FOREIGN KEY(sense_id) REFERENCES senses(id) ON DELETE CASCADE);"
 	};
 
-    char* errMsg {nullptr};
-    sqlite3_exec(db, sql, nullptr, nullptr, &errMsg);
+    exec(sql);
+	createIndexes();
 }
 
-bool Database::insertWord(const std::string& lemma) 
+void Database::createIndexes()
 {
-    sqlite3_stmt* stmt; // prepared SQL statement object
-    const char* sql {"INSERT OR IGNORE INTO words (lemma) VALUES (?);"}; // add new row if word does not exist, otherwise ignore
+	// secondary indexes for lookups by word/sense (and forms by text), the UNIQUE lemma index stays with the table
+	exec(
+		"CREATE INDEX IF NOT EXISTS idx_etymologys_word ON etymologys(word_id);"
+		"CREATE INDEX IF NOT EXISTS idx_forms_word ON forms(word_id);"
+		"CREATE INDEX IF NOT EXISTS idx_forms_form ON forms(form, word_id, tag);" // covers reloading one letter's forms
+		"CREATE INDEX IF NOT EXISTS idx_senses_word ON senses(word_id);"
+		"CREATE INDEX IF NOT EXISTS idx_examples_sense ON examples(sense_id);"
+		"CREATE INDEX IF NOT EXISTS idx_synonyms_sense ON synonyms(sense_id);"
+		"CREATE INDEX IF NOT EXISTS idx_antonyms_sense ON antonyms(sense_id);"
+	);
+}
 
-	/* 
-	db → your open database
-	sql → the SQL string
-	-1 → read full string
-	&stmt → where to store the compiled statement
-	nullptr → ignore unused output
-	*/	
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+void Database::dropIndexes()
+{
+	exec(
+		"DROP INDEX IF EXISTS idx_etymologys_word;"
+		"DROP INDEX IF EXISTS idx_forms_word;"
+		"DROP INDEX IF EXISTS idx_forms_form;"
+		"DROP INDEX IF EXISTS idx_senses_word;"
+		"DROP INDEX IF EXISTS idx_examples_sense;"
+		"DROP INDEX IF EXISTS idx_synonyms_sense;"
+		"DROP INDEX IF EXISTS idx_antonyms_sense;"
+	);
+}
+
+void Database::beginBulkImport()
+{
+	if (m_bulk) return;
+
+	// remember the current settings so endBulkImport can put them back
+	{
+		Statement stmt {prepare("PRAGMA journal_mode;")};
+		if (stmt && sqlite3_step(stmt.get()) == SQLITE_ROW)
+			m_journalMode = reinterpret_cast<const char *>(sqlite3_column_text(stmt.get(), 0));
+	}
+	{
+		Statement stmt {prepare("PRAGMA synchronous;")};
+		if (stmt && sqlite3_step(stmt.get()) == SQLITE_ROW) m_synchronous = sqlite3_column_int(stmt.get(), 0);
+	}
+
+	// WAL appends instead of rewriting pages, and nothing is fsynced until the import is done
+	exec("PRAGMA journal_mode = WAL;");
+	exec("PRAGMA synchronous = OFF;");
+
+	// maintaining indexes row by row is slower than building them once at the end
+	dropIndexes();
+
+	m_bulk = true;
+	beginTransaction();
+}
+
+void Database::endBulkImport()
+{
+	if (!m_bulk) return;
+
+	commit();
+	createIndexes();
+
+	std::string restore {"PRAGMA synchronous = " + std::to_string(m_synchronous) + ";"
+		"PRAGMA journal_mode = " + m_journalMode + ";"};
+	exec(restore.c_str());
+	m_bulk = false;
+}
+
+bool Database::beginTransaction() { return exec("BEGIN TRANSACTION;"); }
+
+bool Database::commit() { return exec("COMMIT;"); }
+
+bool Database::insertWord(const std::string& lemma) 
+{
+    // add new row if word does not exist, otherwise ignore
+    Statement stmt {prepare("INSERT OR IGNORE INTO words (lemma) VALUES (?);")}; // prepared SQL statement object
+    if (!stmt) return false;
 
 	/*
 	stmt → prepared statement
@@ -93,52 +214,90 @@ bool Database::insertWord(const std::string& lemma)
 	-1 → length (auto)
 	SQLITE_STATIC → SQLite can safely reference this memory
 	*/
-    sqlite3_bind_text(stmt, 1, lemma.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 1, lemma.c_str(), -1, SQLITE_STATIC);
 	
-	// run the statement
-	if (sqlite3_step(stmt) != SQLITE_DONE) return false; 
-	sqlite3_finalize(stmt); // free the statement from memory to avoid leaks
+	// run the statement (the handle resets it on every return path)
+	if (sqlite3_step(stmt.get()) != SQLITE_DONE) return false; 
     return true; // word inserted successfully
 }
 
 bool Database::insertEtymology(int word_id, const std::vector<std::string> &etymology)
-{ // implement
+{
+    Statement stmt {prepare("INSERT INTO etymologys (word_id, etymology) VALUES (?, ?);")};
+    if (!stmt) return false;
+
+	// one row per paragraph, in order
+	for (const auto &text : etymology)
+	{
+		sqlite3_bind_int(stmt.get(), 1, word_id);
+		sqlite3_bind_text(stmt.get(), 2, text.c_str(), -1, SQLITE_STATIC);
+		if (sqlite3_step(stmt.get()) != SQLITE_DONE) return false;
+		sqlite3_reset(stmt.get());
+	}
 	return true;
 }	
 
 bool Database::insertForm(int word_id, const std::string &form, const std::string &tag)
-{ // implement
+{
+    Statement stmt {prepare("INSERT INTO forms (word_id, form, tag) VALUES (?, ?, ?);")};
+    if (!stmt) return false;
+
+    sqlite3_bind_int(stmt.get(), 1, word_id);
+    sqlite3_bind_text(stmt.get(), 2, form.c_str(), -1, SQLITE_STATIC);
+	if (tag.empty()) sqlite3_bind_null(stmt.get(), 3);
+	else sqlite3_bind_text(stmt.get(), 3, tag.c_str(), -1, SQLITE_STATIC);
+
+	if (sqlite3_step(stmt.get()) != SQLITE_DONE) return false;
 	return true;
 }
 
-bool Database::insertSense(int word_id, const std::string& pos, const std::string& definition) 
+int Database::insertSense(int word_id, const std::string& pos, const std::string& definition) 
 {
-    sqlite3_stmt* stmt;
-    const char* sql = "INSERT INTO senses (word_id, pos, definition) VALUES (?, ?, ?);";
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return false;
+    Statement stmt {prepare("INSERT INTO senses (word_id, pos, definition) VALUES (?, ?, ?);")};
+    if (!stmt) return -1;
 
 	// fill values
-    sqlite3_bind_int(stmt, 1, word_id);
-    sqlite3_bind_text(stmt, 2, pos.c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, definition.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt.get(), 1, word_id);
+    sqlite3_bind_text(stmt.get(), 2, pos.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt.get(), 3, definition.c_str(), -1, SQLITE_STATIC);
 
-	if (sqlite3_step(stmt) != SQLITE_DONE) return false;
-    sqlite3_finalize(stmt);
-	return true;
+	if (sqlite3_step(stmt.get()) != SQLITE_DONE) return -1;
+	return static_cast<int>(sqlite3_last_insert_rowid(db)); // examples, synonyms and antonyms hang off it
 }
 
-bool Database::insertExample(int word_id, const std::string &example)
-{ // implement
+bool Database::insertExample(int sense_id, const std::string &example)
+{
+    Statement stmt {prepare("INSERT INTO examples (sense_id, example) VALUES (?, ?);")};
+    if (!stmt) return false;
+
+    sqlite3_bind_int(stmt.get(), 1, sense_id);
+    sqlite3_bind_text(stmt.get(), 2, example.c_str(), -1, SQLITE_STATIC);
+
+	if (sqlite3_step(stmt.get()) != SQLITE_DONE) return false;
 	return true;
 }
 
-bool Database::insertSynonym(int word_id, const std::string &synonym)
-{ // implement
+bool Database::insertSynonym(int sense_id, const std::string &synonym)
+{
+    Statement stmt {prepare("INSERT INTO synonyms (sense_id, synonym) VALUES (?, ?);")};
+    if (!stmt) return false;
+
+    sqlite3_bind_int(stmt.get(), 1, sense_id);
+    sqlite3_bind_text(stmt.get(), 2, synonym.c_str(), -1, SQLITE_STATIC);
+
+	if (sqlite3_step(stmt.get()) != SQLITE_DONE) return false;
 	return true;
 }
 
-bool Database::insertAntonym(int word_id, const std::string &antonym)
-{ // implement
+bool Database::insertAntonym(int sense_id, const std::string &antonym)
+{
+    Statement stmt {prepare("INSERT INTO antonyms (sense_id, antonyms) VALUES (?, ?);")};
+    if (!stmt) return false;
+
+    sqlite3_bind_int(stmt.get(), 1, sense_id);
+    sqlite3_bind_text(stmt.get(), 2, antonym.c_str(), -1, SQLITE_STATIC);
+
+	if (sqlite3_step(stmt.get()) != SQLITE_DONE) return false;
 	return true;
 }
 
@@ -147,24 +306,146 @@ bool Database::removeWord(int word_id)
 	return false;
 }
 
-int Database::getWordID(const std::string &lemma)
+int Database::getLastWordID()
 {
-	sqlite3_stmt* stmt;
-	const char* sql {"SELECT id FROM words WHERE lemma = ?;"};
+	Statement stmt {prepare("SELECT MAX(id) FROM words;")};
+	if (!stmt) return -1;
+
+	// MAX() of an empty table is NULL, which reads back as 0
+	int word_id {0};
+	if (sqlite3_step(stmt.get()) == SQLITE_ROW) word_id = sqlite3_column_int(stmt.get(), 0);
+
+	return word_id;
+}
 
-	// prepare the sql statement
-	if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) return -1;
+long long Database::getTotalChanges() { return sqlite3_total_changes(db); }
+
+int Database::getWordID(const std::string &lemma)
+{
+	// prepared once, reused by every lookup
+	Statement stmt {prepare("SELECT id FROM words WHERE lemma = ?;")};
+	if (!stmt) return -1;
 
 	// bind the word into the ?
-	sqlite3_bind_text(stmt, 1, lemma.c_str(), -1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt.get(), 1, lemma.c_str(), -1, SQLITE_STATIC);
 
 	// execute the query
 	int word_id = -1;
-	if (sqlite3_step(stmt) == SQLITE_ROW)
+	if (sqlite3_step(stmt.get()) == SQLITE_ROW)
 	{
-		word_id = sqlite3_column_int(stmt, 0);
+		word_id = sqlite3_column_int(stmt.get(), 0);
 	}
 
-	sqlite3_finalize(stmt);
 	return word_id;
 }
+
+bool Database::fetchEntry(int word_id, WordInfo &out)
+{
+	// out's vectors and strings are written over in place and trimmed at the end, so a WordInfo
+	// reused across calls stops allocating once it has held an entry as big as the next one
+	std::size_t etymologies {0}, forms {0}, senses {0};
+	m_senseIDs.clear();
+	out.id = -1;
+
+	// the word and what hangs off it directly: (kind, owner, text, extra, rowid). Ordering by rowid
+	// alone lets SQLite merge the branches as their indexes hand them over, no sorting, and keeps
+	// each kind in insertion order
+	{
+		Statement stmt {prepare(
+			"SELECT 0, id, lemma, NULL, id FROM words WHERE id = ?1 "
+			"UNION ALL SELECT 1, word_id, etymology, NULL, id FROM etymologys WHERE word_id = ?1 "
+			"UNION ALL SELECT 2, word_id, form, tag, id FROM forms WHERE word_id = ?1 "
+			"UNION ALL SELECT 3, id, pos, definition, id FROM senses WHERE word_id = ?1 "
+			"ORDER BY 5;")};
+		if (!stmt) return false;
+		sqlite3_bind_int(stmt.get(), 1, word_id);
+
+		while (sqlite3_step(stmt.get()) == SQLITE_ROW)
+		{
+			sqlite3_stmt *row {stmt.get()};
+			switch (sqlite3_column_int(row, 0))
+			{
+				case 0:
+					out.id = sqlite3_column_int(row, 1);
+					assignText(out.lemma, row, 2);
+					break;
+				case 1: assignText(nextSlot(out.etymology, etymologies), row, 2); break;
+				case 2:
+				{
+					WordInfo::Form &form {nextSlot(out.forms, forms)};
+					assignText(form.form, row, 2);
+					assignText(form.tag, row, 3);
+					break;
+				}
+				case 3:
+				{
+					WordInfo::Sense &sense {nextSlot(out.senses, senses)};
+					assignText(sense.pos, row, 2);
+					assignText(sense.definition, row, 3);
+					m_senseIDs.push_back(sqlite3_column_int(row, 1)); // ascending, with rowid
+					break;
+				}
+			}
+		}
+	}
+	out.etymology.resize(etymologies);
+	out.forms.resize(forms);
+	out.senses.resize(senses);
+	if (out.id != word_id)
+	{
+		out.lemma.clear();
+		return false;
+	}
+
+	// examples, synonyms and antonyms, grouped by sense in sense order (the join walks senses by id,
+	// then each child index in rowid order, so this ORDER BY is free too). One sense is open at a
+	// time: its counts say how much of each list has been overwritten so far
+	Statement stmt {prepare(
+		"SELECT 4, s.id, e.example, NULL, e.id FROM senses s JOIN examples e ON e.sense_id = s.id WHERE s.word_id = ?1 "
+		"UNION ALL SELECT 5, s.id, y.synonym, NULL, y.id FROM senses s JOIN synonyms y ON y.sense_id = s.id WHERE s.word_id = ?1 "
+		"UNION ALL SELECT 6, s.id, a.antonyms, NULL, a.id FROM senses s JOIN antonyms a ON a.sense_id = s.id WHERE s.word_id = ?1 "
+		"ORDER BY 2, 5;")};
+	if (!stmt) return false;
+	sqlite3_bind_int(stmt.get(), 1, word_id);
+
+	std::size_t open {0};
+	std::size_t counts[3] {0, 0, 0}; // examples, synonyms, antonyms of out.senses[open]
+	auto close {[&out, &open, &counts]()
+	{
+		WordInfo::Sense &sense {out.senses[open++]};
+		sense.examples.resize(counts[0]);
+		sense.synonyms.resize(counts[1]);
+		sense.antonyms.resize(counts[2]);
+		counts[0] = counts[1] = counts[2] = 0;
+	}};
+
+	while (sqlite3_step(stmt.get()) == SQLITE_ROW)
+	{
+		sqlite3_stmt *row {stmt.get()};
+		int sense_id {sqlite3_column_int(row, 1)};
+		while (open < senses && m_senseIDs[open] < sense_id) close(); // senses with nothing (more) attached
+		if (open == senses || m_senseIDs[open] != sense_id) continue; // added since the first query
+
+		int kind {sqlite3_column_int(row, 0) - 4};
+		WordInfo::Sense &sense {out.senses[open]};
+		std::vector<std::string> &list {kind == 0 ? sense.examples : kind == 1 ? sense.synonyms : sense.antonyms};
+		assignText(nextSlot(list, counts[kind]), row, 2);
+	}
+	while (open < senses) close();
+	return true;
+}
+
+/*********************************
+// Database Helper Functions
+**********************************/
+bool Database::exec(const char *sql)
+{
+	char *errMsg {nullptr};
+	if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK)
+	{
+		std::cerr << "SQL error: " << (errMsg ? errMsg : "unknown") << '\n';
+		sqlite3_free(errMsg);
+		return false;
+	}
+	return true;
+}
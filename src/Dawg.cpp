@@ -0,0 +1,239 @@
+#include "Dawg.h"
+#include "Utils.h"
+#include <fstream>
+
+Dawg::Dawg() { clear(); }
+
+bool Dawg::insert(std::string_view word, int word_id)
+{
+	if (m_finished || word.empty()) return false;
+
+	for (char c : word)
+	{
+		if (c < 'a' || c > 'z') return false; // normalize() should have removed it
+	}
+
+	// incremental minimization only works on sorted, unique input
+	if (!m_wordIDs.empty() && word <= m_lastWord) return false;
+
+	// everything below the prefix shared with the previous word is final now
+	std::size_t common {0};
+	while (common < word.size() && common < m_lastWord.size() && word[common] == m_lastWord[common]) ++common;
+	minimize(common);
+
+	// open a fresh path for the rest of the word
+	for (std::size_t i{common}; i < word.size(); ++i)
+	{
+		OpenNode node;
+		node.m_letter = word[i];
+		m_path.push_back(std::move(node));
+	}
+	m_path.back().m_isEndOfWord = true;
+
+	m_wordIDs.push_back(word_id); // sorted input, so the rank is the insertion order
+	m_lastWord.assign(word);
+	return true;
+}
+
+void Dawg::finish()
+{
+	if (m_finished) return;
+
+	minimize(0);
+	m_root = freeze(m_path.front());
+
+	// build state is not needed for queries
+	std::vector<OpenNode>().swap(m_path);
+	std::unordered_map<std::string, std::uint32_t>().swap(m_register);
+	std::string().swap(m_lastWord);
+	m_finished = true;
+}
+
+bool Dawg::loadFile(const std::string &filename)
+{
+	std::ifstream file(filename);
+	if (!file) return false;
+
+	clear();
+
+	std::string word;
+	int id {0};
+	while (std::getline(file, word))
+	{
+		++id;
+		if (!word.empty() && word.back() == '\r') word.pop_back();
+		insert(word, id); // out of order or non-alpha lines are skipped
+	}
+
+	finish();
+	return true;
+}
+
+void Dawg::clear()
+{
+	std::vector<DawgNode>().swap(m_nodes);
+	std::vector<std::uint32_t>().swap(m_edges);
+	std::vector<int>().swap(m_wordIDs);
+	std::unordered_map<std::string, std::uint32_t>().swap(m_register);
+	m_lastWord.clear();
+	m_finished = false;
+
+	m_nodes.emplace_back(); // dead state
+	m_root = m_nil;
+	m_path.assign(1, OpenNode()); // open root
+}
+
+bool Dawg::contains(std::string_view word) const
+{
+	std::uint32_t node {findNode(word)};
+	return node != m_nil && m_nodes[node].m_isEndOfWord;
+}
+
+bool Dawg::startsWith(std::string_view prefix) const { return findNode(prefix) != m_nil; }
+
+bool Dawg::isEmpty() const { return m_wordIDs.empty(); }
+
+std::size_t Dawg::size() const { return m_wordIDs.size(); }
+
+int Dawg::getWordID(std::string_view word) const
+{
+	int index {wordIndex(word)};
+	return index < 0 ? -1 : m_wordIDs[index];
+}
+
+int Dawg::wordIndex(std::string_view word) const
+{
+	if (m_root == m_nil) return -1;
+
+	std::uint32_t node {m_root};
+	int rank {0};
+
+	// every word that sorts before this one is either ended on the way down
+	// or sits under a smaller sibling edge
+	for (char c : word)
+	{
+		int index {c - 'a'};
+		if (index < 0 || index >= dct::g_alpha) return -1;
+
+		const DawgNode &n {m_nodes[node]};
+		if (!n.hasChild(index)) return -1;
+
+		if (n.m_isEndOfWord) ++rank;
+		for (int i{0}; i < n.slot(index); ++i) rank += m_nodes[m_edges[n.m_children + i]].m_count;
+
+		node = m_edges[n.m_children + n.slot(index)];
+	}
+
+	return m_nodes[node].m_isEndOfWord ? rank : -1;
+}
+
+void Dawg::collectWithPrefix(std::string_view prefix, std::vector<std::string> &out, std::size_t limit) const
+{
+	std::uint32_t node {findNode(prefix)};
+	if (node == m_nil) return; // prefix not found
+
+	std::string currentWord {prefix};
+	collectFromNode(node, currentWord, out, limit);
+}
+
+void Dawg::memoryReport(std::ostream &out) const
+{
+	std::size_t nodes {m_nodes.size() - 1};
+	std::size_t edges {m_edges.size()};
+	std::size_t words {m_wordIDs.size()};
+	std::size_t bytes {nodes * sizeof(DawgNode) + edges * sizeof(std::uint32_t) + words * sizeof(int)};
+
+	out << "words: " << words << '\n'
+		<< "nodes: " << nodes << " (" << edges << " edges)\n"
+		<< "dawg: " << bytes << " bytes";
+	if (words) out << " (" << static_cast<double>(bytes) / words << " bytes/word)";
+	out << '\n';
+}
+
+/*********************************
+// Dawg Helper Functions
+*********************************/
+void Dawg::minimize(std::size_t depth)
+{
+	// freeze open nodes deeper than depth and hang them off their parent
+	while (m_path.size() > depth + 1)
+	{
+		OpenNode node {std::move(m_path.back())};
+		m_path.pop_back();
+
+		std::uint32_t frozen {freeze(node)};
+		m_path.back().m_children.emplace_back(node.m_letter - 'a', frozen);
+	}
+}
+
+std::uint32_t Dawg::freeze(const OpenNode &open)
+{
+	// two nodes are equivalent if they agree on finality and on every outgoing edge
+	std::string signature;
+	signature.push_back(open.m_isEndOfWord ? '1' : '0');
+	for (const auto &[letter, target] : open.m_children)
+	{
+		signature.push_back(static_cast<char>('a' + letter));
+		signature.append(reinterpret_cast<const char *>(&target), sizeof(target));
+	}
+
+	auto found {m_register.find(signature)};
+	if (found != m_register.end()) return found->second;
+
+	// new state, children arrive in letter order because the input is sorted
+	DawgNode node;
+	node.m_isEndOfWord = open.m_isEndOfWord;
+	node.m_count = open.m_isEndOfWord ? 1 : 0;
+	node.m_children = static_cast<std::uint32_t>(m_edges.size());
+
+	for (const auto &[letter, target] : open.m_children)
+	{
+		node.m_childMask |= (1u << letter);
+		node.m_count += m_nodes[target].m_count;
+		m_edges.push_back(target);
+	}
+
+	std::uint32_t id {static_cast<std::uint32_t>(m_nodes.size())};
+	m_nodes.push_back(node);
+	m_register.emplace(std::move(signature), id);
+	return id;
+}
+
+std::uint32_t Dawg::child(std::uint32_t node, int index) const
+{
+	const DawgNode &n {m_nodes[node]};
+	return n.hasChild(index) ? m_edges[n.m_children + n.slot(index)] : m_nil;
+}
+
+std::uint32_t Dawg::findNode(std::string_view word) const
+{
+	std::uint32_t node {m_root};
+
+	for (char c : word)
+	{
+		if (node == m_nil) return m_nil;
+
+		int index {c - 'a'};
+		if (index < 0 || index >= dct::g_alpha) return m_nil;
+		node = child(node, index);
+	}
+
+	return node;
+}
+
+void Dawg::collectFromNode(std::uint32_t node, std::string &currentWord, std::vector<std::string> &out, std::size_t limit) const
+{ // same traversal as Trie::collectFromNode
+	if (out.size() >= limit) return;
+	if (m_nodes[node].m_isEndOfWord) out.push_back(currentWord);
+
+	for (int i{0}; i < dct::g_alpha && out.size() < limit; ++i)
+	{
+		std::uint32_t next {child(node, i)};
+		if (next != m_nil)
+		{
+			currentWord.push_back(static_cast<char>('a' + i));
+			collectFromNode(next, currentWord, out, limit);
+			currentWord.pop_back();
+		}
+	}
+}
@@ -1,10 +1,38 @@
 #include "Dictionary.h"
 #include "Utils.h"
+#include <chrono>
+#include "EditDistance.h"
+#include "Normalize.h"
+#include "ThreadPool.h"
+#include <filesystem>
+#include <cstdint>
+#include <thread>
+#include <tuple>
+#include <algorithm>
+
+namespace
+{
+	// forms worth a trie node: one word (Wiktextract also lists phrases like "has run"), and not
+	// one of the placeholder entries naming the inflection table or template
+	bool isTrieForm(std::string_view form, std::string_view tag)
+	{
+		if (form.find(' ') != std::string_view::npos || !dct::hasLetter(form)) return false;
+		return tag != "table-tags" && tag != "inflection-template" && tag != "class";
+	}
+}
 
 Dictionary::Dictionary() : m_db{dct::g_dictDb}
 {
 	m_db.createTables();	
-	buildTrie(m_db); // implement lemma logic 
+
+	// map the saved trie if it matches the database and frequency file, otherwise rebuild and save it for next time
+	if (!loadImage())
+	{
+		buildTrie(m_db); // implement lemma logic 
+		loadFrequencies(dct::g_dictFreq);
+		m_trie.buildTopTable(); // short prefixes answer from a table
+		saveImage();
+	}
 }
 
 bool Dictionary::addWord(std::string_view word)
@@ -12,46 +40,150 @@ bool Dictionary::addWord(std::string_view word)
 	std::string cleanWord {normalize(word)};
 	if (cleanWord.empty()) return false;
 
+	std::lock_guard<std::mutex> lock {m_writeMutex};
+
 	// insert into db
-	if (m_db.insertWord(cleanWord)) return false;
+	if (!m_db.insertWord(cleanWord)) return false;
 	int word_id {m_db.getWordID(cleanWord)};
 	if (word_id <= 0) return false;
 
 	// insert into trie
-	if (!m_trie.insert(cleanWord, word_id)) return false;
-
-	return true;	
+	bool added {m_live ? m_live->insert(cleanWord, word_id) : m_trie.insert(cleanWord, word_id)};
+	if (added) ++m_generation;
+	return added;	
 }
 
 bool Dictionary::removeWord(std::string_view word)
 { // implement remove from db
-	if (m_trie.isEmpty()) return false;
+	if (isEmpty()) return false;
 
-	std::string cleanWord {normalize(word)};
+	dct::NormalizedWord cleanWord {word};
 	if (cleanWord.empty()) return false;
 
-	if (!m_trie.remove(cleanWord)) return false;
+	std::lock_guard<std::mutex> lock {m_writeMutex};
+	int word_id {lookup(cleanWord.view())};
+	m_cache.erase(word_id);
+	if (!(m_live ? m_live->remove(cleanWord.view()) : m_trie.remove(cleanWord.view()))) return false;
 
+	// a lemma takes its forms with it, or "running" would still resolve to the "run" just removed
+	if (word_id > 0 && m_db.getWordID(std::string{cleanWord.view()}) == word_id) removeForms(word_id);
 	return true;
 }
 
 bool Dictionary::search(std::string_view word) const
 {
-	if (m_trie.isEmpty()) return false;
+	if (isEmpty()) return false;
 
-	std::string cleanWord {normalize(word)};
-	if (cleanWord.empty()) return false;
-	return m_trie.contains(cleanWord);
+	// the trie normalizes as it walks, so a lookup copies nothing
+	if (!dct::hasLetter(word)) return false;
+	if (m_live) return m_live->contains(word);
+	return m_trie.contains(word);
+}
+
+int Dictionary::lookup(std::string_view word) const
+{
+	if (!dct::hasLetter(word)) return -1;
+
+	// forms are trie words too, so resolving one is the same single descent as search
+	if (m_live) return m_live->findID(word);
+	return m_trie.findID(word);
 }
 
+std::shared_ptr<const WordInfo> Dictionary::getInfo(std::string_view word)
+{
+	int word_id {lookup(word)}; // a form gets its lemma's entry
+	if (word_id <= 0) return nullptr;
+
+	if (auto cached {m_cache.find(word_id)}) return cached;
+
+	// one query per miss into the reused m_fetched, so a miss only allocates the copy, sized to fit;
+	// the cache decides whether the entry is worth keeping
+	WordInfo info;
+	{
+		std::lock_guard<std::mutex> lock {m_writeMutex};
+		if (!m_db.fetchEntry(word_id, m_fetched)) return nullptr;
+		info = m_fetched;
+	}
+	return m_cache.insert(word_id, std::move(info));
+}
+
+const WordCache &Dictionary::cache() const { return m_cache; }
+
 void Dictionary::suggestFromPrefix(std::string_view prefix, std::vector<std::string> &results, std::size_t limit) const 
 {
-	std::string cleanPrefix {normalize(prefix)};
-	if (cleanPrefix.empty()) return;
-	m_trie.collectWithPrefix(cleanPrefix, results, limit+1); // LOGIC ERROR: (off by 1) - balance the prefix being removed from the results
+	if (!dct::hasLetter(prefix)) return;
+	if (m_live) m_live->collectWithPrefix(prefix, results, limit, false);
+	else m_trie.collectWithPrefix(prefix, results, limit, false); // the prefix itself is not a suggestion
+}
+
+void Dictionary::suggestCorrections(std::string_view word, std::vector<std::string> &results, std::size_t limit) const
+{
+	dct::NormalizedWord cleanWord {word};
+	if (cleanWord.empty()) return;
+
+	std::vector<std::pair<std::string, int>> candidates;
+	m_trie.collectWithinDistance(cleanWord.view(), dct::g_maxEdit, candidates);
 
-	// remove the prefix from the results vector
-	results.erase(std::remove(results.begin(), results.end(), prefix), results.end());
+	dct::rankCandidates(candidates, results, limit);
+}
+
+void Dictionary::getWords(std::vector<std::string> &out) const 
+{ 
+	m_trie.collectAll(out); 
+}
+
+Trie::Cursor Dictionary::getCursor() const { return Trie::Cursor{m_trie}; }
+
+void Dictionary::setConcurrent(bool live)
+{
+	std::lock_guard<std::mutex> lock {m_writeMutex};
+	if (live == static_cast<bool>(m_live)) return;
+
+	std::vector<Trie::WordEntry> entries;
+	if (live)
+	{
+		m_trie.collectEntries(entries);
+		m_live = std::make_unique<ConcurrentTrie>();
+		m_live->build(entries);
+		return;
+	}
+
+	// back to the arena trie, with whatever changed while live
+	m_live->collectEntries(entries);
+	m_live.reset();
+	m_trie.clear();
+	for (const Trie::WordEntry &entry : entries)
+	{
+		if (entry.m_isForm) m_trie.insertForm(entry.m_word, entry.m_wordID);
+		else m_trie.insert(entry.m_word, entry.m_wordID);
+		if (entry.m_score) m_trie.setScore(entry.m_word, entry.m_score);
+	}
+	m_trie.buildTopTable();
+}
+
+bool Dictionary::isConcurrent() const { return static_cast<bool>(m_live); }
+
+std::size_t Dictionary::loadFrequencies(const std::string &filename)
+{
+	std::ifstream file(filename);
+	if (!file) return 0; // optional, suggestions stay alphabetical without it
+
+	// a score per line: cheaper to rebuild the completion table after than to keep it current throughout
+	bool hadTable {m_trie.hasTopTable()};
+	m_trie.clearTopTable();
+
+	std::size_t scored {0};
+	std::string word;
+	unsigned long long count {0};
+	while (file >> word >> count)
+	{
+		// counts past 32 bits only need to keep their order against each other
+		std::uint32_t score {static_cast<std::uint32_t>(std::min<unsigned long long>(count, UINT32_MAX))};
+		if (m_trie.setScore(dct::NormalizedWord{word}.view(), score)) ++scored;
+	}
+
+	if (hadTable) m_trie.buildTopTable();
+	return scored;
 }
 
 // void Dictionary::loadTxt(const string &filename) { load(filename); } // expendable
@@ -60,11 +192,23 @@ void Dictionary::print() const { m_trie.print(); }
 
 void Dictionary::dump() const { m_trie.dump(); }
 
-void Dictionary::dumpWord(std::string_view word) const { m_trie.dumpWord(word); }
+void Dictionary::dumpWord(std::string_view word) const 
+{ 
+	m_trie.dumpWord(word); 
+	if (m_trie.isForm(word)) std::cout << "(form of word #" << m_trie.findID(word) << ")\n";
+}
+
+void Dictionary::eraseAll()
+{
+	std::lock_guard<std::mutex> lock {m_writeMutex};
+	m_trie.clear();
+	if (m_live) m_live->build({}); // readers move on to an empty root, and leaving live mode keeps it empty
+	m_cache.clear();
+}
 
-void Dictionary::eraseAll() { m_trie.clear(); }
+bool Dictionary::isEmpty() const { return m_live ? m_live->isEmpty() : m_trie.isEmpty(); }
 
-bool Dictionary::isEmpty() const { return m_trie.isEmpty(); }
+std::uint64_t Dictionary::generation() const { return m_generation.load(); }
 
 void Dictionary::loadInfo(const std::string &filename)
 {
@@ -83,7 +227,7 @@ void Dictionary::loadInfo(const std::string &filename)
 	else extension = filename.substr(p);
 
 	// temporary
-	if (extension == ".json")
+	if (extension == ".json" || extension == ".jsonl") // Wiktextract dumps are JSON lines
 	{
 	    loadjson(filename);
 	} else
@@ -114,152 +258,300 @@ void Dictionary::loadInfo(const std::string &filename)
 **********************************/
 std::string Dictionary::normalize(std::string_view word) const 
 {
-	std::string cleanWord {""};
-	for (char c : word)
+	std::string cleanWord(word.size(), '\0');
+	cleanWord.resize(dct::normalizeInto(word, cleanWord.data()));
+	return cleanWord;
+}
+
+bool Dictionary::loadImage() { return m_trie.load(dct::g_dictImg, imageStamp()); }
+
+bool Dictionary::saveImage() { return m_trie.save(dct::g_dictImg, imageStamp()); }
+
+std::uint64_t Dictionary::imageStamp()
+{
+	// the last word id stamps the image, so any later insert into the database marks it stale;
+	// so does touching the frequency file the scores came from
+	std::uint64_t stamp {static_cast<std::uint64_t>(m_db.getLastWordID())};
+
+	std::error_code error;
+	auto size {std::filesystem::file_size(dct::g_dictFreq, error)};
+	if (error) return stamp;
+	auto modified {std::filesystem::last_write_time(dct::g_dictFreq, error).time_since_epoch().count()};
+
+	return stamp ^ (static_cast<std::uint64_t>(size) * 1099511628211ull) ^ (static_cast<std::uint64_t>(modified) << 1);
+}
+
+void Dictionary::buildTrie(Database &db) 
+{
+	// one ordered scan of (id, lemma): the UNIQUE index on lemma already returns rows
+	// sorted, so each first letter is one run and every loader only appends the suffix
+	// a word doesn't share with the last one
+    Database::Statement stmt {db.prepare("SELECT id, lemma FROM words ORDER BY lemma;")};
+    if (!stmt) return;
+
+	unsigned threads {dct::g_buildThreads ? dct::g_buildThreads : std::thread::hardware_concurrency()};
+	if (threads <= 1)
 	{
-		if (!isalpha(static_cast<unsigned char>(c))) continue;
+		// no shards to build side by side, so the rows go straight into one loader without being kept
+		Trie::Loader loader {m_trie};
+		while (sqlite3_step(stmt.get()) == SQLITE_ROW) 
 		{
-		    // tolower() returns int, passing a negative value = undefined behavior
-		    cleanWord.push_back(tolower(static_cast<unsigned char>(c))); 
-		}	
+			int word_id {sqlite3_column_int(stmt.get(), 0)};
+			std::string_view word {reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1)), static_cast<std::size_t>(sqlite3_column_bytes(stmt.get(), 1))};
+			loader.add(word, word_id);
+		}
 	}
-	return cleanWord;
+	else
+	{
+		// every lemma goes into one buffer and the rows are views of it, rather than a string each
+		std::string text;
+		std::vector<std::pair<int, std::size_t>> ends;
+		while (sqlite3_step(stmt.get()) == SQLITE_ROW) 
+		{
+			text.append(reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 1)), static_cast<std::size_t>(sqlite3_column_bytes(stmt.get(), 1)));
+			ends.emplace_back(sqlite3_column_int(stmt.get(), 0), text.size());
+		}
+
+		std::vector<std::pair<int, std::string_view>> rows;
+		rows.reserve(ends.size());
+		std::size_t start {0};
+		for (const auto &[word_id, end] : ends)
+		{
+			rows.emplace_back(word_id, std::string_view{text}.substr(start, end - start));
+			start = end;
+		}
+		buildShards(rows, threads);
+	}
+	loadForms(db, m_trie); // after every lemma, so a form never takes a spelling a lemma owns
 }
 
-void Dictionary::buildTrie(Database &db) 
+std::size_t Dictionary::loadForms(Database &db, Trie &trie, char letter)
+{
+	// the form column is raw text, so the letter is checked after normalizing; given a letter, SQL
+	// already leaves out every form that can't normalize to it (only those starting with the letter
+	// in either case, or with something normalizing skips, can), each range a walk of idx_forms_form
+    Database::Statement stmt {db.prepare(letter
+		? "SELECT id, word_id, form, tag FROM forms WHERE form < 'A' "
+			"UNION ALL SELECT id, word_id, form, tag FROM forms WHERE form >= ?1 AND form < ?2 "
+			"UNION ALL SELECT id, word_id, form, tag FROM forms WHERE form >= '[' AND form < 'a' "
+			"UNION ALL SELECT id, word_id, form, tag FROM forms WHERE form >= ?3 AND form < ?4 "
+			"UNION ALL SELECT id, word_id, form, tag FROM forms WHERE form >= '{';"
+		: "SELECT id, word_id, form, tag FROM forms;")};
+    if (!stmt) return 0;
+	const char upper[2] {static_cast<char>(letter - 'a' + 'A'), static_cast<char>(letter - 'a' + 'A' + 1)}; // bound static, so they outlive the steps
+	const char lower[2] {letter, static_cast<char>(letter + 1)};
+	if (letter)
+	{
+		sqlite3_bind_text(stmt.get(), 1, upper, 1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt.get(), 2, upper + 1, 1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt.get(), 3, lower, 1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt.get(), 4, lower + 1, 1, SQLITE_STATIC);
+	}
+
+	// the first lemma to claim a form keeps it, so forms go in in table order; the ranges come
+	// back in index order, so a letter's forms are put back in order first (cheaper here than in SQL,
+	// once the phrases and other letters are gone)
+	std::vector<std::tuple<sqlite3_int64, int, std::string>> sorted;
+	std::size_t loaded {0};
+    while (sqlite3_step(stmt.get()) == SQLITE_ROW) 
+	{
+		int word_id {sqlite3_column_int(stmt.get(), 1)};
+		std::string_view form {reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 2)), static_cast<std::size_t>(sqlite3_column_bytes(stmt.get(), 2))};
+		const unsigned char *tag {sqlite3_column_text(stmt.get(), 3)}; // NULL when untagged
+		if (!isTrieForm(form, tag ? reinterpret_cast<const char*>(tag) : "")) continue;
+
+		dct::NormalizedWord cleanForm {form};
+		if (!letter) loaded += trie.insertForm(cleanForm.view(), word_id);
+		else if (cleanForm.view().front() == letter) sorted.emplace_back(sqlite3_column_int64(stmt.get(), 0), word_id, std::string{cleanForm.view()});
+	}
+
+	std::sort(sorted.begin(), sorted.end());
+	for (const auto &[id, word_id, form] : sorted) loaded += trie.insertForm(form, word_id);
+	return loaded;
+}
+
+void Dictionary::buildShards(const std::vector<std::pair<int, std::string_view>> &rows, unsigned threads)
 {
-    sqlite3* sqlDB = m_db.getDB();
-    sqlite3_stmt* stmt;
-    const char* query = "SELECT lemma FROM words;";
-    sqlite3_prepare_v2(sqlDB, query, -1, &stmt, nullptr);
-    while (sqlite3_step(stmt) == SQLITE_ROW) 
+	// the run of rows under each letter (rows starting with anything else are left out, as the loader would)
+	std::vector<std::pair<std::size_t, std::size_t>> runs(dct::g_alpha, {0, 0});
+	auto first {[&rows](std::size_t r) { return rows[r].second.empty() ? '\0' : rows[r].second[0]; }};
+	for (std::size_t i{0}; i < rows.size();)
+	{
+		std::size_t j {i + 1};
+		while (j < rows.size() && first(j) == first(i)) ++j;
+
+		int index {first(i) - 'a'};
+		if (index >= 0 && index < dct::g_alpha) runs[index] = {i, j};
+		i = j;
+	}
+
+	std::vector<Trie> shards(dct::g_alpha);
 	{
-        const unsigned char* text = sqlite3_column_text(stmt, 0);
-		std::string word {reinterpret_cast<const char*>(text)};
-        m_trie.insert(word, m_db.getWordID(word)); 
+		ThreadPool pool {threads};
+		ThreadPool::TaskGroup tasks {pool};
+		for (int i{0}; i < dct::g_alpha; ++i)
+		{
+			if (runs[i].first == runs[i].second) continue;
+			tasks.submit([&rows, &runs, &shards, i]()
+			{
+				Trie::Loader loader {shards[i]};
+				for (std::size_t r {runs[i].first}; r < runs[i].second; ++r) loader.add(rows[r].second, rows[r].first);
+			});
+		}
+		tasks.wait();
 	}
-    sqlite3_finalize(stmt);
+
+	m_trie.adoptShards(shards); // each appended whole to the arena, no per node copy
 }
 
-bool Dictionary::loadjson(const std::string &filename)
+std::size_t Dictionary::reloadShard(char letter)
+{
+	int index {dct::letterIndex(letter)};
+	if (index < 0) return 0;
+	letter = static_cast<char>('a' + index);
+
+	std::lock_guard<std::mutex> lock {m_writeMutex};
+	if (m_live) return 0; // would be lost when live mode ends
+
+	// lemmas from letter up to (not including) the next letter
+	Database::Statement stmt {m_db.prepare("SELECT id, lemma FROM words WHERE lemma >= ?1 AND lemma < ?2 ORDER BY lemma;")};
+	if (!stmt) return 0;
+	const char from[2] {letter, '\0'};
+	const char to[2] {static_cast<char>(letter + 1), '\0'};
+	sqlite3_bind_text(stmt.get(), 1, from, 1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt.get(), 2, to, 1, SQLITE_STATIC);
+
+	Trie shard;
+	std::size_t words {0};
+	{
+		Trie::Loader loader {shard};
+		while (sqlite3_step(stmt.get()) == SQLITE_ROW)
+		{
+			int word_id {sqlite3_column_int(stmt.get(), 0)};
+			const unsigned char* text = sqlite3_column_text(stmt.get(), 1);
+			std::string_view word {reinterpret_cast<const char*>(text), static_cast<std::size_t>(sqlite3_column_bytes(stmt.get(), 1))};
+			if (loader.add(word, word_id)) ++words;
+		}
+	}
+
+	words += loadForms(m_db, shard, letter);
+
+	// words that were already there keep their scores
+	std::vector<Trie::WordEntry> entries;
+	shard.collectEntries(entries);
+	for (const Trie::WordEntry &entry : entries)
+	{
+		if (std::uint32_t score {m_trie.getScore(entry.m_word)}) shard.setScore(entry.m_word, score);
+	}
+
+	m_trie.setShard(letter, shard); // and the completion rows under letter, the others stand
+	++m_generation; // the database may hold words the trie didn't
+	return words;
+}
+
+void Dictionary::storeEntry(WordInfo &word)
+{
+	// insert into trie and database
+	addWord(word.lemma);
+
+	// get word_id from database (stored under the normalized lemma, as addWord wrote it)
+	word.id = m_db.getWordID(normalize(word.lemma));
+	if (word.id <= 0) return;
+	m_cache.erase(word.id); // whatever was cached for it is missing this entry
+
+	// Etymology
+	if (!word.etymology.empty()) m_db.insertEtymology(word.id, word.etymology);
+
+	// Forms (plurals, alt spellings): the trie resolves them to the lemma without asking the database
+	for (const auto &form : word.forms)
+	{
+		m_db.insertForm(word.id, form.form, form.tag);
+		if (isTrieForm(form.form, form.tag)) addForm(normalize(form.form), word.id);
+	}
+
+	// Senses
+	for (const auto &sense : word.senses)
+	{
+		int sense_id {m_db.insertSense(word.id, sense.pos, sense.definition)};
+		if (sense_id <= 0) continue;
+
+		for (const auto &ex : sense.examples)
+			m_db.insertExample(sense_id, ex);
+
+		for (const auto &syn : sense.synonyms)
+			m_db.insertSynonym(sense_id, syn);
+
+		for (const auto &ant : sense.antonyms)
+			m_db.insertAntonym(sense_id, ant);
+	}
+}
+
+void Dictionary::removeForms(int lemma_id)
+{
+	Database::Statement stmt {m_db.prepare("SELECT form FROM forms WHERE word_id = ?1;")};
+	if (!stmt) return;
+	sqlite3_bind_int(stmt.get(), 1, lemma_id);
+
+	while (sqlite3_step(stmt.get()) == SQLITE_ROW)
+	{
+		// only forms still resolving to the lemma: one another lemma claimed first (or is) stays
+		dct::NormalizedWord form {std::string_view{reinterpret_cast<const char*>(sqlite3_column_text(stmt.get(), 0)), static_cast<std::size_t>(sqlite3_column_bytes(stmt.get(), 0))}};
+		if (form.empty() || lookup(form.view()) != lemma_id) continue;
+
+		if (m_live) m_live->remove(form.view());
+		else m_trie.remove(form.view());
+	}
+}
+
+bool Dictionary::addForm(std::string_view form, int lemma_id)
+{
+	if (form.empty() || lemma_id <= 0) return false;
+
+	std::lock_guard<std::mutex> lock {m_writeMutex};
+	bool added {m_live ? m_live->insertForm(form, lemma_id) : m_trie.insertForm(form, lemma_id)};
+	if (added) ++m_generation;
+	return added;
+}
+
+bool Dictionary::loadjson(const std::string &filename, std::size_t batchSize, unsigned threads)
 {	
 	std::ifstream file(filename);
 	if (!file) throw std::runtime_error("Error: Cannot open external dictionary.\n");
+	file.close(); // the pipeline maps the file itself
+
+	// group entries into large transactions instead of one autocommit (and fsync) per row
+	auto start {std::chrono::steady_clock::now()};
+	long long rowsBefore {m_db.getTotalChanges()};
+	std::size_t entries {0};
+	m_db.beginBulkImport();
+	m_trie.clearTopTable(); // rebuilt once at the end, not row by row for every entry
+
+	// lines are SAX parsed on worker threads, this thread writes the entries in file order
+	// so word ids come out the same as a sequential import
+	ImportPipeline pipeline {threads};
+	pipeline.run(filename, [&](WordInfo &word)
+	{
+		storeEntry(word);
+		++entries;
 
-	std::string line;
-    while (std::getline(file, line))
-    {
-        try
-        {
-            nlohmann::json j = nlohmann::json::parse(line);
-
-            // skip entries without a word
-            if (!j.contains("word")) continue;
-
-			// retrieve json word data into "word" and insert into DB
-            WordInfo word;
-            word.lemma = j["word"];
-
-            // insert into trie and database
-            addWord(word.lemma);
-
-            // get word_id from database
-            word.id = m_db.getWordID(word.lemma);
-
-            // Etymology
-            if (j.contains("etymology_text"))
-            {
-                std::string etymology = j["etymology_text"];
-                
-				// split by lines into vector
-                std::istringstream ety_stream(etymology);
-                std::string ety_line;
-                while (std::getline(ety_stream, ety_line))
-                    word.etymology.push_back(ety_line); // build the etymology vector
-
-                m_db.insertEtymology(word.id, word.etymology);
-            }
-
-            // Forms (plurals, alt spellings)
-            if (j.contains("forms"))
-            {
-                for (auto &f : j["forms"])
-                {
-                    WordInfo::Form form;
-                    
-					// Form
-                    form.form = f.value("form", "");
-
-					// Tag (if there is one)
-                    form.tag = f.contains("tags") && !f["tags"].empty() ? f["tags"][0].get<std::string>() : "";
-                    word.forms.push_back(form); // vector of Forms for autocomplete / sepllchecking
-
-                    m_db.insertForm(word.id, form.form, form.tag);
-                }
-            }
-
-            // Senses
-            if (j.contains("senses"))
-            {
-                for (auto &sense_json : j["senses"])
-                {
-                    WordInfo::Sense sense;
-
-                    // POS (part of speech)
-                    sense.pos = sense_json.value("pos", j.value("pos", ""));
-
-                    // Definitions / glosses
-                    if (sense_json.contains("glosses"))
-                    {
-                        for (auto &g : sense_json["glosses"])
-                            sense.definition += g.get<std::string>() + " "; // concatenate multiple glosses
-                    }
-
-                    // Examples
-                    if (sense_json.contains("examples"))
-                    {
-                        for (auto &ex : sense_json["examples"])
-                            sense.examples.push_back(ex.get<std::string>()); // build examples vector
-                    }
-
-                    // Synonyms
-                    if (sense_json.contains("synonyms"))
-                    {
-                        for (auto &syn : sense_json["synonyms"])
-                            sense.synonyms.push_back(syn.get<std::string>()); // build synonyms vector
-                    }
-
-                    // Antonyms
-                    if (sense_json.contains("antonyms"))
-                    {
-                        for (auto &ant : sense_json["antonyms"])
-                            sense.antonyms.push_back(ant.get<std::string>()); // build antonyms vector
-                    }
-
-                    word.senses.push_back(sense); // vector of senses for potentinal quick lookups
-
-                    // Insert into DB
-                    m_db.insertSense(word.id, sense.pos, sense.definition);
-
-                    for (const auto &ex : sense.examples)
-                        m_db.insertExample(word.id, ex);
-
-                    for (const auto &syn : sense.synonyms)
-                        m_db.insertSynonym(word.id, syn);
-
-                    for (const auto &ant : sense.antonyms)
-                        m_db.insertAntonym(word.id, ant);
-                }
-            }
-
-			// ADD TO DICTIONARY??	
-			//m_words[word.lemma] = word; // add to Dictionary storage??? (map<string, WordInfo>)
-        }
-        catch (const std::exception& e)
-        {
-            std::cerr << "Skipping bad line: " << e.what() << "\n";
-        }
-    }
-
+		// start a new transaction every batchSize entries
+		if (batchSize && entries % batchSize == 0)
+		{
+			m_db.commit();
+			m_db.beginTransaction();
+		}
+	});
+
+	m_db.endBulkImport(); // commits the last batch and rebuilds the indexes
+
+	std::chrono::duration<double> elapsed {std::chrono::steady_clock::now() - start};
+	long long rows {m_db.getTotalChanges() - rowsBefore};
+	std::cout << "Imported " << entries << " entries (" << rows << " rows) in " << elapsed.count() << " s";
+	if (elapsed.count() > 0) std::cout << " (" << static_cast<long long>(rows / elapsed.count()) << " rows/sec)";
+	std::cout << std::endl;
+
+	loadFrequencies(dct::g_dictFreq); // imported words start unscored
+	m_trie.buildTopTable();
+	saveImage(); // next launch maps the imported trie instead of rebuilding it
     return true;
 }
@@ -0,0 +1,332 @@
+#include "EditDistance.h"
+#include <algorithm>
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DCT_X86 1
+#endif
+
+int dct::editDistance(std::string_view a, std::string_view b)
+{
+	return editDistance(a, b, static_cast<int>(std::max(a.size(), b.size())));
+}
+
+int dct::editDistance(std::string_view a, std::string_view b, int maxDistance)
+{
+	int lengthGap {static_cast<int>(a.size()) - static_cast<int>(b.size())};
+	if (lengthGap > maxDistance || -lengthGap > maxDistance) return maxDistance + 1;
+
+	// three rolling rows of the DP table (two back for transpositions), reused per thread
+	std::size_t columns {b.size() + 1};
+	thread_local std::vector<int> buffer;
+	buffer.resize(3 * columns);
+	int *twoAbove {buffer.data()};
+	int *above {twoAbove + columns};
+	int *row {above + columns};
+
+	for (std::size_t j{0}; j < columns; ++j) above[j] = static_cast<int>(j);
+
+	for (std::size_t i{1}; i <= a.size(); ++i)
+	{
+		row[0] = static_cast<int>(i);
+		int rowMin {row[0]};
+
+		for (std::size_t j{1}; j < columns; ++j)
+		{
+			int cost {a[i - 1] == b[j - 1] ? 0 : 1};
+			int best {std::min({above[j] + 1, row[j - 1] + 1, above[j - 1] + cost})};
+			if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) best = std::min(best, twoAbove[j - 2] + 1);
+
+			row[j] = best;
+			rowMin = std::min(rowMin, best);
+		}
+
+		if (rowMin > maxDistance) return maxDistance + 1; // every path already costs too much
+
+		std::swap(twoAbove, above);
+		std::swap(above, row);
+	}
+
+	return std::min(above[b.size()], maxDistance + 1);
+}
+
+int dct::damerauLevenshtein(std::string_view a, std::string_view b)
+{
+	return damerauLevenshtein(a, b, static_cast<int>(std::max(a.size(), b.size())));
+}
+
+int dct::damerauLevenshtein(std::string_view a, std::string_view b, int maxDistance)
+{
+	int lengthGap {static_cast<int>(a.size()) - static_cast<int>(b.size())};
+	if (lengthGap > maxDistance || -lengthGap > maxDistance) return maxDistance + 1;
+
+	// Lowrance-Wagner: a transposition may reach back to any earlier row, so keep the whole table.
+	// Row/column 0 is the border of "infinite" cells, d(i, j) lives at table[(i + 1) * columns + j + 1].
+	std::size_t columns {b.size() + 2};
+	thread_local std::vector<int> table;
+	table.resize((a.size() + 2) * columns);
+	auto d = [&](std::size_t i, std::size_t j) -> int & { return table[(i + 1) * columns + j + 1]; };
+
+	int infinity {static_cast<int>(a.size() + b.size()) + 1};
+	for (std::size_t i{0}; i <= a.size() + 1; ++i) table[i * columns] = infinity;
+	for (std::size_t j{0}; j <= b.size() + 1; ++j) table[j] = infinity;
+	for (std::size_t i{0}; i <= a.size(); ++i) d(i, 0) = static_cast<int>(i);
+	for (std::size_t j{0}; j <= b.size(); ++j) d(0, j) = static_cast<int>(j);
+
+	std::array<std::size_t, 256> lastRow {}; // last row of a holding each letter
+
+	for (std::size_t i{1}; i <= a.size(); ++i)
+	{
+		std::size_t lastMatch {0}; // last column of this row where the letters matched
+		int rowMin {d(i, 0)};
+
+		for (std::size_t j{1}; j <= b.size(); ++j)
+		{
+			std::size_t k {lastRow[static_cast<unsigned char>(b[j - 1])]};
+			std::size_t l {lastMatch};
+			int cost {1};
+			if (a[i - 1] == b[j - 1])
+			{
+				cost = 0;
+				lastMatch = j;
+			}
+
+			int best {std::min({d(i - 1, j - 1) + cost, d(i, j - 1) + 1, d(i - 1, j) + 1})};
+			// swap a[k] with b[l] and edit whatever lies between them
+			if (k > 0 && l > 0) best = std::min(best, d(k - 1, l - 1) + static_cast<int>(i - k - 1) + 1 + static_cast<int>(j - l - 1));
+
+			d(i, j) = best;
+			rowMin = std::min(rowMin, best);
+		}
+
+		// row minima never shrink (a transposition pays for every row it skips)
+		if (rowMin > maxDistance) return maxDistance + 1;
+		lastRow[static_cast<unsigned char>(a[i - 1])] = i;
+	}
+
+	return std::min(d(a.size(), b.size()), maxDistance + 1);
+}
+
+/*********************************
+// EditPattern
+*********************************/
+namespace
+{
+	enum class Kernel { Scalar, Sse2, Avx2 };
+
+	Kernel detectKernel()
+	{
+#ifdef DCT_X86
+		if (__builtin_cpu_supports("avx2")) return Kernel::Avx2;
+#endif
+#ifdef __SSE2__
+		return Kernel::Sse2;
+#else
+		return Kernel::Scalar;
+#endif
+	}
+
+	const Kernel g_kernel {detectKernel()};
+
+	std::size_t longest(const std::string_view *candidates, std::size_t count)
+	{
+		std::size_t length {0};
+		for (std::size_t i{0}; i < count; ++i) length = std::max(length, candidates[i].size());
+		return length;
+	}
+
+	// The batched kernels run the scalar recurrence in every 32-bit lane, one candidate per lane.
+	// Lanes whose candidate has ended keep stepping on a letter that matches nothing, but their
+	// score is no longer updated. matches is the query's 32-bit match table, m its length (1-32).
+#ifdef DCT_X86
+	__attribute__((target("avx2")))
+	void distancesAvx2(const std::uint32_t *matches, int m, const std::string_view *candidates, int *out)
+	{
+		const __m256i ones {_mm256_set1_epi32(-1)};
+		const __m256i last {_mm256_set1_epi32(static_cast<int>(1u << (m - 1)))};
+		__m256i vp {ones}, vn {_mm256_setzero_si256()}, d0 {_mm256_setzero_si256()}, previous {_mm256_setzero_si256()};
+		__m256i score {_mm256_set1_epi32(m)};
+		__m256i lengths {_mm256_setr_epi32(
+			static_cast<int>(candidates[0].size()), static_cast<int>(candidates[1].size()),
+			static_cast<int>(candidates[2].size()), static_cast<int>(candidates[3].size()),
+			static_cast<int>(candidates[4].size()), static_cast<int>(candidates[5].size()),
+			static_cast<int>(candidates[6].size()), static_cast<int>(candidates[7].size()))};
+
+		std::size_t length {longest(candidates, 8)};
+		alignas(32) int letters[8];
+
+		for (std::size_t j{0}; j < length; ++j)
+		{
+			for (int lane{0}; lane < 8; ++lane)
+				letters[lane] = j < candidates[lane].size() ? static_cast<unsigned char>(candidates[lane][j]) : 0;
+
+			__m256i match {_mm256_i32gather_epi32(reinterpret_cast<const int *>(matches), _mm256_load_si256(reinterpret_cast<const __m256i *>(letters)), 4)};
+			__m256i active {_mm256_cmpgt_epi32(lengths, _mm256_set1_epi32(static_cast<int>(j)))};
+
+			__m256i swap {_mm256_and_si256(_mm256_slli_epi32(_mm256_andnot_si256(d0, match), 1), previous)};
+			d0 = _mm256_xor_si256(_mm256_add_epi32(_mm256_and_si256(match, vp), vp), vp);
+			d0 = _mm256_or_si256(_mm256_or_si256(d0, match), _mm256_or_si256(vn, swap));
+			__m256i hp {_mm256_or_si256(vn, _mm256_xor_si256(_mm256_or_si256(d0, vp), ones))};
+			__m256i hn {_mm256_and_si256(d0, vp)};
+
+			// a set top bit is +1 / -1 on the last row; the compare yields -1 for set, so subtract / add it
+			score = _mm256_sub_epi32(score, _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(hp, last), last), active));
+			score = _mm256_add_epi32(score, _mm256_and_si256(_mm256_cmpeq_epi32(_mm256_and_si256(hn, last), last), active));
+
+			hp = _mm256_or_si256(_mm256_slli_epi32(hp, 1), _mm256_set1_epi32(1));
+			hn = _mm256_slli_epi32(hn, 1);
+			vp = _mm256_or_si256(hn, _mm256_xor_si256(_mm256_or_si256(d0, hp), ones));
+			vn = _mm256_and_si256(hp, d0);
+			previous = match;
+		}
+
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(out), score);
+	}
+#endif
+
+#ifdef __SSE2__
+	void distancesSse2(const std::uint32_t *matches, int m, const std::string_view *candidates, int *out)
+	{
+		const __m128i ones {_mm_set1_epi32(-1)};
+		const __m128i last {_mm_set1_epi32(static_cast<int>(1u << (m - 1)))};
+		__m128i vp {ones}, vn {_mm_setzero_si128()}, d0 {_mm_setzero_si128()}, previous {_mm_setzero_si128()};
+		__m128i score {_mm_set1_epi32(m)};
+		__m128i lengths {_mm_setr_epi32(
+			static_cast<int>(candidates[0].size()), static_cast<int>(candidates[1].size()),
+			static_cast<int>(candidates[2].size()), static_cast<int>(candidates[3].size()))};
+
+		std::size_t length {longest(candidates, 4)};
+		auto letter = [&](int lane, std::size_t j) -> int
+		{
+			return static_cast<int>(matches[j < candidates[lane].size() ? static_cast<unsigned char>(candidates[lane][j]) : 0]);
+		};
+
+		for (std::size_t j{0}; j < length; ++j)
+		{
+			__m128i match {_mm_setr_epi32(letter(0, j), letter(1, j), letter(2, j), letter(3, j))}; // no gather before AVX2
+			__m128i active {_mm_cmpgt_epi32(lengths, _mm_set1_epi32(static_cast<int>(j)))};
+
+			__m128i swap {_mm_and_si128(_mm_slli_epi32(_mm_andnot_si128(d0, match), 1), previous)};
+			d0 = _mm_xor_si128(_mm_add_epi32(_mm_and_si128(match, vp), vp), vp);
+			d0 = _mm_or_si128(_mm_or_si128(d0, match), _mm_or_si128(vn, swap));
+			__m128i hp {_mm_or_si128(vn, _mm_xor_si128(_mm_or_si128(d0, vp), ones))};
+			__m128i hn {_mm_and_si128(d0, vp)};
+
+			score = _mm_sub_epi32(score, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(hp, last), last), active));
+			score = _mm_add_epi32(score, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(hn, last), last), active));
+
+			hp = _mm_or_si128(_mm_slli_epi32(hp, 1), _mm_set1_epi32(1));
+			hn = _mm_slli_epi32(hn, 1);
+			vp = _mm_or_si128(hn, _mm_xor_si128(_mm_or_si128(d0, hp), ones));
+			vn = _mm_and_si128(hp, d0);
+			previous = match;
+		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out), score);
+	}
+#endif
+}
+
+dct::EditPattern::EditPattern(std::string_view word) : m_word{word}
+{
+	for (std::size_t i{0}; i < m_word.size() && i < 64; ++i)
+	{
+		m_matches[static_cast<unsigned char>(m_word[i])] |= std::uint64_t{1} << i;
+	}
+	for (std::size_t c{0}; c < m_matches.size(); ++c) m_matches32[c] = static_cast<std::uint32_t>(m_matches[c]);
+}
+
+int dct::EditPattern::distance(std::string_view candidate) const
+{
+	return distance(candidate, static_cast<int>(std::max(m_word.size(), candidate.size())));
+}
+
+int dct::EditPattern::distance(std::string_view candidate, int maxDistance) const
+{
+	int m {static_cast<int>(m_word.size())};
+	int n {static_cast<int>(candidate.size())};
+	if (m - n > maxDistance || n - m > maxDistance) return maxDistance + 1;
+	if (m == 0) return n;
+	if (m > 64) return editDistance(m_word, candidate, maxDistance);
+
+	// vertical deltas of the current DP column: vp bit i = D[i+1][j] - D[i][j] is +1, vn = -1;
+	// score tracks the last row, D[m][j]
+	std::uint64_t vp {~std::uint64_t{0}}, vn {0}, d0 {0}, previous {0};
+	const std::uint64_t last {std::uint64_t{1} << (m - 1)};
+	int score {m};
+
+	for (int j{0}; j < n; ++j)
+	{
+		std::uint64_t match {m_matches[static_cast<unsigned char>(candidate[j])]};
+		std::uint64_t swap {((~d0 & match) << 1) & previous}; // the adjacent swap reaches back one diagonal
+
+		d0 = (((match & vp) + vp) ^ vp) | match | vn | swap; // diagonal zero deltas
+		std::uint64_t hp {vn | ~(d0 | vp)};
+		std::uint64_t hn {d0 & vp};
+
+		if (hp & last) ++score;
+		else if (hn & last) --score;
+
+		// every letter left can lower the last row by at most 1
+		if (score - (n - j - 1) > maxDistance) return maxDistance + 1;
+
+		hp = (hp << 1) | 1; // row 0 grows by one per column
+		hn <<= 1;
+		vp = hn | ~(d0 | hp);
+		vn = hp & d0;
+		previous = match;
+	}
+
+	return std::min(score, maxDistance + 1);
+}
+
+void dct::EditPattern::distances(const std::string_view *candidates, std::size_t count, int *out) const
+{
+	std::size_t i {0};
+	int m {static_cast<int>(m_word.size())};
+
+	if (m >= 1 && m <= 32)
+	{
+#ifdef DCT_X86
+		if (g_kernel == Kernel::Avx2)
+		{
+			for (; i + 8 <= count; i += 8) distancesAvx2(m_matches32.data(), m, candidates + i, out + i);
+		}
+#endif
+#ifdef __SSE2__
+		if (g_kernel != Kernel::Scalar)
+		{
+			for (; i + 4 <= count; i += 4) distancesSse2(m_matches32.data(), m, candidates + i, out + i);
+		}
+#endif
+	}
+
+	for (; i < count; ++i) out[i] = distance(candidates[i]); // the rest (or everything when the query is too long)
+}
+
+std::size_t dct::EditPattern::size() const { return m_word.size(); }
+
+const char *dct::EditPattern::batchKernel()
+{
+	switch (g_kernel)
+	{
+		case Kernel::Avx2: return "avx2";
+		case Kernel::Sse2: return "sse2";
+		default: return "scalar";
+	}
+}
+
+void dct::rankCandidates(std::vector<std::pair<std::string, int>> &candidates, std::vector<std::string> &results, std::size_t limit)
+{
+	std::sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b)
+	{
+		return a.second != b.second ? a.second < b.second : a.first < b.first;
+	});
+
+	for (auto &candidate : candidates)
+	{
+		if (results.size() >= limit) break;
+		results.push_back(std::move(candidate.first));
+	}
+}
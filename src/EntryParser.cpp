@@ -0,0 +1,254 @@
+#include "EntryParser.h"
+#include <utility>
+
+bool EntryParser::parse(std::string_view line)
+{
+	reset();
+
+	m_failed = !nlohmann::json::sax_parse(line.data(), line.data() + line.size(), this);
+	if (m_failed || !m_hasWord) return false; // skip entries without a word
+
+	// split the etymology by lines (same as reading it with getline)
+	std::size_t start {0};
+	while (start < m_etymology.size())
+	{
+		std::size_t end {m_etymology.find('\n', start)};
+		if (end == std::string::npos) end = m_etymology.size();
+		append(m_entry.etymology, std::string_view{m_etymology}.substr(start, end - start));
+		start = end + 1;
+	}
+
+	// senses without their own part of speech use the entry's
+	for (auto &sense : m_entry.senses)
+	{
+		if (sense.pos.empty()) sense.pos = m_entryPos;
+	}
+
+	return true;
+}
+
+/*********************************
+// SAX Events
+**********************************/
+bool EntryParser::null() { return true; }
+
+bool EntryParser::boolean(bool) { return true; }
+
+bool EntryParser::number_integer(nlohmann::json::number_integer_t) { return true; }
+
+bool EntryParser::number_unsigned(nlohmann::json::number_unsigned_t) { return true; }
+
+bool EntryParser::number_float(nlohmann::json::number_float_t, const std::string &) { return true; }
+
+bool EntryParser::binary(nlohmann::json::binary_t &) { return true; }
+
+bool EntryParser::string(std::string &val)
+{
+	if (m_scopes.empty()) return true;
+
+	switch (m_scopes.back())
+	{
+	case Scope::Entry:
+		if (m_key == Key::Word) 
+		{
+			m_entry.lemma.assign(val);
+			m_hasWord = true;
+		}
+		else if (m_key == Key::Pos) m_entryPos.assign(val);
+		else if (m_key == Key::Etymology) m_etymology.assign(val);
+		break;
+
+	case Scope::Form:
+		if (m_key == Key::Form) m_entry.forms.back().form.assign(val);
+		break;
+
+	case Scope::Tags:
+		// only the first tag is kept
+		if (m_entry.forms.back().tag.empty()) m_entry.forms.back().tag.assign(val);
+		break;
+
+	case Scope::Sense:
+		if (m_key == Key::Pos) m_entry.senses.back().pos.assign(val);
+		break;
+
+	case Scope::Glosses:
+		m_entry.senses.back().definition.append(val).push_back(' '); // concatenate multiple glosses
+		break;
+
+	// examples are {"text": ...} objects in Wiktextract, plain strings are accepted too
+	case Scope::Examples: append(m_entry.senses.back().examples, val); break;
+	case Scope::Example: if (m_key == Key::Text) append(m_entry.senses.back().examples, val); break;
+
+	// synonyms/antonyms are {"word": ...} objects, plain strings are accepted too
+	case Scope::Synonyms: append(m_entry.senses.back().synonyms, val); break;
+	case Scope::Synonym: if (m_key == Key::Word) append(m_entry.senses.back().synonyms, val); break;
+	case Scope::Antonyms: append(m_entry.senses.back().antonyms, val); break;
+	case Scope::Antonym: if (m_key == Key::Word) append(m_entry.senses.back().antonyms, val); break;
+
+	default: break;
+	}
+
+	return true;
+}
+
+bool EntryParser::start_object(std::size_t)
+{
+	Scope parent {m_scopes.empty() ? Scope::Root : m_scopes.back()};
+
+	switch (parent)
+	{
+	case Scope::Root: pushScope(Scope::Entry); break;
+
+	case Scope::Forms:
+		if (m_freeForms.empty()) m_entry.forms.emplace_back();
+		else
+		{
+			m_entry.forms.push_back(std::move(m_freeForms.back()));
+			m_freeForms.pop_back();
+		}
+		pushScope(Scope::Form);
+		break;
+
+	case Scope::Senses:
+		if (m_freeSenses.empty()) m_entry.senses.emplace_back();
+		else
+		{
+			m_entry.senses.push_back(std::move(m_freeSenses.back()));
+			m_freeSenses.pop_back();
+		}
+		pushScope(Scope::Sense);
+		break;
+
+	case Scope::Examples: pushScope(Scope::Example); break;
+	case Scope::Synonyms: pushScope(Scope::Synonym); break;
+	case Scope::Antonyms: pushScope(Scope::Antonym); break;
+	default: pushScope(Scope::Skip); break;
+	}
+
+	m_key = Key::Other;
+	return true;
+}
+
+bool EntryParser::end_object()
+{
+	m_scopes.pop_back();
+	return true;
+}
+
+bool EntryParser::start_array(std::size_t)
+{
+	Scope parent {m_scopes.empty() ? Scope::Root : m_scopes.back()};
+	Scope scope {Scope::Skip};
+
+	if (parent == Scope::Entry)
+	{
+		if (m_key == Key::Forms) scope = Scope::Forms;
+		else if (m_key == Key::Senses) scope = Scope::Senses;
+	}
+	else if (parent == Scope::Form)
+	{
+		if (m_key == Key::Tags) scope = Scope::Tags;
+	}
+	else if (parent == Scope::Sense)
+	{
+		if (m_key == Key::Glosses) scope = Scope::Glosses;
+		else if (m_key == Key::Examples) scope = Scope::Examples;
+		else if (m_key == Key::Synonyms) scope = Scope::Synonyms;
+		else if (m_key == Key::Antonyms) scope = Scope::Antonyms;
+	}
+
+	pushScope(scope);
+	return true;
+}
+
+bool EntryParser::end_array()
+{
+	m_scopes.pop_back();
+	return true;
+}
+
+bool EntryParser::key(std::string &val)
+{
+	// only the keys the parser acts on, everything else is skipped
+	static const std::pair<std::string_view, Key> keys[] {
+		{"word", Key::Word}, {"pos", Key::Pos}, {"etymology_text", Key::Etymology},
+		{"forms", Key::Forms}, {"senses", Key::Senses}, {"form", Key::Form}, {"tags", Key::Tags},
+		{"glosses", Key::Glosses}, {"examples", Key::Examples}, {"synonyms", Key::Synonyms},
+		{"antonyms", Key::Antonyms}, {"text", Key::Text},
+	};
+
+	m_key = Key::Other;
+
+	// keys inside skipped values can't matter
+	if (m_scopes.empty() || m_scopes.back() == Scope::Skip) return true;
+
+	for (const auto &[name, key] : keys)
+	{
+		if (val == name)
+		{
+			m_key = key;
+			break;
+		}
+	}
+	return true;
+}
+
+bool EntryParser::parse_error(std::size_t, const std::string &, const nlohmann::json::exception &) { return false; }
+
+/*********************************
+// EntryParser Helper Functions
+**********************************/
+void EntryParser::reset()
+{
+	// hand the previous entry's storage back to the free lists
+	for (auto &form : m_entry.forms)
+	{
+		form.form.clear();
+		form.tag.clear();
+		m_freeForms.push_back(std::move(form));
+	}
+	m_entry.forms.clear();
+
+	for (auto &sense : m_entry.senses)
+	{
+		sense.pos.clear();
+		sense.definition.clear();
+		recycle(sense.examples);
+		recycle(sense.synonyms);
+		recycle(sense.antonyms);
+		m_freeSenses.push_back(std::move(sense));
+	}
+	m_entry.senses.clear();
+
+	recycle(m_entry.etymology);
+	m_entry.lemma.clear();
+	m_entry.id = -1;
+
+	m_etymology.clear();
+	m_entryPos.clear();
+	m_scopes.clear();
+	m_key = Key::Other;
+	m_hasWord = false;
+	m_failed = false;
+}
+
+void EntryParser::recycle(std::vector<std::string> &list)
+{
+	for (auto &s : list) m_freeStrings.push_back(std::move(s));
+	list.clear(); // keeps the vector's capacity
+}
+
+void EntryParser::append(std::vector<std::string> &list, std::string_view value)
+{
+	if (m_freeStrings.empty())
+	{
+		list.emplace_back(value);
+		return;
+	}
+
+	list.push_back(std::move(m_freeStrings.back()));
+	m_freeStrings.pop_back();
+	list.back().assign(value.data(), value.size());
+}
+
+void EntryParser::pushScope(Scope scope) { m_scopes.push_back(scope); }
@@ -0,0 +1,167 @@
+#include "ImportPipeline.h"
+#include "BoundedQueue.h"
+#include "MappedFile.h"
+#include <thread>
+#include <map>
+#include <iostream>
+
+ImportPipeline::ImportPipeline(unsigned threads) : m_threads{threads}
+{
+	if (m_threads == 0) m_threads = std::thread::hardware_concurrency();
+	if (m_threads == 0) m_threads = 1;
+}
+
+bool ImportPipeline::run(const std::string &filename, const std::function<void(WordInfo &)> &sink)
+{
+	MappedFile file;
+	if (!file.open(filename)) return false;
+	m_badLines = 0;
+
+	// a couple of batches in flight per worker keeps everyone busy without buffering the whole file
+	BoundedQueue<Batch> toParse {2 * static_cast<std::size_t>(m_threads)};
+	BoundedQueue<Parsed> toWrite {2 * static_cast<std::size_t>(m_threads)};
+	// ... and no more than that between the reader and the writer either: the reader puts each batch's
+	// seq in here before handing it out, the writer takes one out once it has written a batch, so one
+	// slow batch can't leave every later one piling up in the writer's reorder buffer
+	BoundedQueue<std::size_t> inFlight {2 * static_cast<std::size_t>(m_threads)};
+
+	// reader: slice the mapping into batches of lines (no copies)
+	std::thread reader {[&]()
+	{
+		std::string_view text {file.data(), file.size()};
+		Batch batch;
+		std::size_t seq {0}, lineNumber {0};
+
+		while (!text.empty())
+		{
+			std::size_t end {text.find('\n')};
+			std::string_view line {text.substr(0, end)};
+			text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+			if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+			if (batch.m_lines.empty()) batch.m_firstLine = lineNumber + 1;
+			batch.m_lines.push_back(line);
+			++lineNumber;
+
+			if (batch.m_lines.size() == dct::g_importLines)
+			{
+				batch.m_seq = seq++;
+				if (!inFlight.push(batch.m_seq) || !toParse.push(std::move(batch))) return;
+				batch = Batch();
+			}
+		}
+
+		if (!batch.m_lines.empty())
+		{
+			batch.m_seq = seq;
+			if (inFlight.push(batch.m_seq)) toParse.push(std::move(batch));
+		}
+		toParse.close();
+	}};
+
+	// parsed batches the writer has finished with, so their entries' storage goes round again
+	std::vector<Parsed> spare;
+	std::mutex spareMutex;
+
+	// parsers: each owns its EntryParser, batches come back in whatever order they finish
+	std::vector<std::thread> workers;
+	std::size_t running {m_threads};
+	std::mutex runningMutex;
+
+	for (unsigned i{0}; i < m_threads; ++i)
+	{
+		workers.emplace_back([&]()
+		{
+			EntryParser parser;
+			Batch batch;
+			while (toParse.pop(batch))
+			{
+				Parsed parsed;
+				{
+					std::lock_guard<std::mutex> lock {spareMutex};
+					if (!spare.empty())
+					{
+						parsed = std::move(spare.back());
+						spare.pop_back();
+					}
+				}
+				parseBatch(parser, batch, parsed);
+				if (!toWrite.push(std::move(parsed))) break;
+			}
+
+			// the last parser out closes the writer's queue
+			std::lock_guard<std::mutex> lock {runningMutex};
+			if (--running == 0) toWrite.close();
+		});
+	}
+
+	// writer (this thread): put batches back in file order before handing entries to the sink
+	auto stop {[&]()
+	{
+		inFlight.close();
+		toParse.close();
+		toWrite.close();
+		reader.join();
+		for (auto &worker : workers) worker.join();
+	}};
+
+	try
+	{
+		std::map<std::size_t, Parsed> pending;
+		std::size_t next {0};
+		Parsed parsed;
+
+		while (toWrite.pop(parsed))
+		{
+			pending.emplace(parsed.m_seq, std::move(parsed));
+
+			for (auto it {pending.begin()}; it != pending.end() && it->first == next; it = pending.erase(it), ++next)
+			{
+				for (std::size_t line : it->second.m_badLines) std::cerr << "Skipping bad line " << line << "\n";
+				m_badLines += it->second.m_badLines.size();
+
+				for (std::size_t i{0}; i < it->second.m_count; ++i) sink(it->second.m_entries[i]);
+
+				{
+					std::lock_guard<std::mutex> lock {spareMutex};
+					spare.push_back(std::move(it->second));
+				}
+				std::size_t written;
+				inFlight.pop(written); // lets the reader hand out one more
+			}
+		}
+	}
+	catch (...)
+	{
+		stop(); // don't leave threads blocked on a queue nobody drains
+		throw;
+	}
+
+	stop();
+	return true;
+}
+
+/*********************************
+// ImportPipeline Helper Functions
+**********************************/
+void ImportPipeline::parseBatch(EntryParser &parser, const Batch &batch, Parsed &out) const
+{
+	out.m_seq = batch.m_seq;
+	out.m_count = 0;
+	out.m_badLines.clear();
+	out.m_entries.reserve(batch.m_lines.size());
+
+	for (std::size_t i{0}; i < batch.m_lines.size(); ++i)
+	{
+		if (parser.parse(batch.m_lines[i]))
+		{
+			// swapped, not moved: the parser recycles whatever the slot held before into the next line
+			if (out.m_count == out.m_entries.size()) out.m_entries.emplace_back();
+			std::swap(out.m_entries[out.m_count++], parser.entry());
+		}
+		else if (parser.failed())
+		{
+			out.m_badLines.push_back(batch.m_firstLine + i);
+		}
+	}
+}
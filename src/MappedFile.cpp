@@ -0,0 +1,67 @@
+#include "MappedFile.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept { *this = std::move(other); }
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+	if (this == &other) return *this;
+
+	close();
+	m_data = other.m_data;
+	m_size = other.m_size;
+	m_open = other.m_open;
+
+	// the mapping now belongs to this object
+	other.m_data = nullptr;
+	other.m_size = 0;
+	other.m_open = false;
+	return *this;
+}
+
+bool MappedFile::open(const std::string &filename)
+{
+	close();
+
+	int fd {::open(filename.c_str(), O_RDONLY)};
+	if (fd < 0) return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	m_size = static_cast<std::size_t>(info.st_size);
+	if (m_size > 0) // mmap rejects empty files, an empty mapping is still valid
+	{
+		void *data {mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0)};
+		if (data == MAP_FAILED)
+		{
+			::close(fd);
+			m_size = 0;
+			return false;
+		}
+		m_data = static_cast<const char *>(data);
+	}
+
+	::close(fd); // the mapping stays valid after the descriptor is closed
+	m_open = true;
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_data) munmap(const_cast<char *>(m_data), m_size);
+
+	m_data = nullptr;
+	m_size = 0;
+	m_open = false;
+}
@@ -0,0 +1,84 @@
+#include "Normalize.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+
+namespace
+{
+	// lowercases the letters in 16 bytes and returns a bitmask of which bytes are letters
+	inline unsigned foldBlock(const char *in, char *out)
+	{
+		__m128i bytes {_mm_loadu_si128(reinterpret_cast<const __m128i *>(in))};
+		__m128i folded {_mm_or_si128(bytes, _mm_set1_epi8(0x20))};
+
+		// unsigned (folded - 'a') < 26, as a signed compare after flipping the top bit
+		__m128i offset {_mm_xor_si128(_mm_sub_epi8(folded, _mm_set1_epi8('a')), _mm_set1_epi8(static_cast<char>(0x80)))};
+		__m128i isLetter {_mm_cmplt_epi8(offset, _mm_set1_epi8(static_cast<char>(0x80 + 26)))};
+
+		// letters get the folded byte, everything else keeps its own
+		__m128i result {_mm_or_si128(_mm_and_si128(isLetter, folded), _mm_andnot_si128(isLetter, bytes))};
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(out), result);
+		return static_cast<unsigned>(_mm_movemask_epi8(isLetter));
+	}
+}
+#endif
+
+std::size_t dct::normalizeInto(std::string_view word, char *out)
+{
+	std::size_t length {0};
+	std::size_t i {0};
+
+#ifdef __SSE2__
+	// long words: 16 bytes at a time, folded straight into out (length never passes i, so there is room)
+	for (; i + 16 <= word.size(); i += 16)
+	{
+		std::size_t base {length};
+		unsigned letters {foldBlock(word.data() + i, out + base)};
+		if (letters == 0xFFFF)
+		{
+			length += 16;
+			continue;
+		}
+
+		// a block with gaps: slide its letters down over the dropped bytes
+		for (unsigned mask {letters}; mask; mask &= mask - 1) out[length++] = out[base + __builtin_ctz(mask)];
+	}
+#endif
+
+	// branch free: every byte is written, only letters move length on
+	for (; i < word.size(); ++i)
+	{
+		unsigned folded {static_cast<unsigned char>(word[i]) | 0x20u};
+		out[length] = static_cast<char>(folded);
+		length += folded - 'a' < 26u;
+	}
+	return length;
+}
+
+void dct::normalizeBatch(const std::string_view *words, std::size_t count, std::string &buffer, std::vector<std::string_view> &out)
+{
+	std::size_t total {0};
+	for (std::size_t i{0}; i < count; ++i) total += words[i].size();
+	buffer.resize(total);
+	out.resize(count);
+	std::size_t write {0};
+	for (std::size_t i{0}; i < count; ++i)
+	{
+		std::size_t n {normalizeInto(words[i], &buffer[write])};
+		out[i] = std::string_view{buffer.data() + write, n};
+		write += n;
+	}
+}
+
+dct::NormalizedWord::NormalizedWord(std::string_view word)
+{
+	if (word.size() <= m_inline)
+	{
+		m_view = std::string_view{m_small, normalizeInto(word, m_small)};
+		return;
+	}
+
+	m_large.resize(word.size());
+	m_large.resize(normalizeInto(word, m_large.data()));
+	m_view = m_large;
+}
@@ -1,14 +1,351 @@
 #include "SpellChecker.h"
 #include "Utils.h"
+#include "EditDistance.h"
+#include "Normalize.h"
+
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// the distinct words seen so far, each with the index it was first given, copied (folded) into
+	// one small arena so probes never reach back into a large document. Words compare with
+	// every byte or-ed with 0x20, eight at a time: that folds case, and since it never turns a
+	// non-letter into a letter (which the trie skips), words it merges always get the same verdict
+	class WordTable
+	{
+	public:
+		// index of word, adding it (added = true) the first time it is seen
+		std::uint32_t intern(std::string_view word, bool &added)
+		{
+			if (2 * (size() + 1) > m_slots.size()) grow();
+
+			std::uint64_t tag {hash(word) >> 32};
+			std::size_t mask {m_slots.size() - 1};
+			std::size_t at {slotFor(tag, mask)};
+			while (m_slots[at] && !((m_slots[at] >> 32) == tag && equal(this->word(static_cast<std::uint32_t>((m_slots[at] & UINT32_MAX) - 1)), word)))
+			{
+				at = (at + 1) & mask;
+			}
+
+			added = !m_slots[at];
+			if (added)
+			{
+				for (char c : word) m_text.push_back(static_cast<char>(c | 0x20));
+				m_starts.push_back(static_cast<std::uint32_t>(m_text.size()));
+				m_slots[at] = tag << 32 | size();
+			}
+			return static_cast<std::uint32_t>((m_slots[at] & UINT32_MAX) - 1);
+		}
+
+		// lowercased (same verdict as the original), valid until the next intern
+		std::string_view word(std::uint32_t index) const { return std::string_view{m_text}.substr(m_starts[index], m_starts[index + 1] - m_starts[index]); }
+		std::uint32_t size() const { return static_cast<std::uint32_t>(m_starts.size() - 1); }
+
+	private:
+		// open addressing, kept under half full; a slot is (top hash bits << 32 | index + 1),
+		// so a probe only reads a word's text when those bits already match
+		std::vector<std::uint64_t> m_slots = std::vector<std::uint64_t>(1024, 0);
+		std::string m_text; // distinct words back to back
+		std::vector<std::uint32_t> m_starts {0}; // word i = m_text[m_starts[i], m_starts[i + 1])
+
+		static std::size_t slotFor(std::uint64_t tag, std::size_t mask) { return static_cast<std::size_t>(tag * 0x9e3779b9u) & mask; }
+
+		void grow()
+		{
+			// the top bits kept in each slot are enough to place it again
+			std::vector<std::uint64_t> grown(m_slots.size() * 2, 0);
+			std::size_t mask {grown.size() - 1};
+			for (std::uint64_t slot : m_slots)
+			{
+				if (!slot) continue;
+				std::size_t at {slotFor(slot >> 32, mask)};
+				while (grown[at]) at = (at + 1) & mask;
+				grown[at] = slot;
+			}
+			m_slots.swap(grown);
+		}
+
+		static std::uint64_t chunk(const char *p, std::size_t n)
+		{
+			std::uint64_t bytes {0};
+			std::memcpy(&bytes, p, n < 8 ? n : 8);
+			return bytes | 0x2020202020202020ull;
+		}
+
+	public:
+		// same value for words that compare equal
+		static std::uint64_t hash(std::string_view word)
+		{
+			std::uint64_t h {word.size() * 0x9e3779b97f4a7c15ull};
+			for (std::size_t i{0}; i < word.size(); i += 8)
+			{
+				h = (h ^ chunk(word.data() + i, word.size() - i)) * 0xff51afd7ed558ccdull;
+				h ^= h >> 32;
+			}
+			h *= 0xc4ceb9fe1a85ec53ull;
+			return h ^ (h >> 33);
+		}
+
+	private:
+		static bool equal(std::string_view a, std::string_view b)
+		{
+			if (a.size() != b.size()) return false;
+			for (std::size_t i{0}; i < a.size(); i += 8)
+			{
+				if (chunk(a.data() + i, a.size() - i) != chunk(b.data() + i, b.size() - i)) return false;
+			}
+			return true;
+		}
+	};
+
+	// what each byte means to the tokenizer
+	enum ByteClass : std::uint8_t { Gap, Letter, Other, Apostrophe };
+
+	struct ByteClasses
+	{
+		std::uint8_t m_class[256] {};
+
+		constexpr ByteClasses()
+		{
+			for (int c{0}; c < 256; ++c)
+			{
+				if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') m_class[c] = Letter;
+				else if ((c >= '0' && c <= '9') || c >= 0x80) m_class[c] = Other;
+				else if (c == '\'') m_class[c] = Apostrophe;
+			}
+		}
+	};
+	constexpr ByteClasses g_bytes;
+
+	inline std::uint8_t byteClass(char c) { return g_bytes.m_class[static_cast<unsigned char>(c)]; }
+
+#ifdef __SSE2__
+	// bit per byte of the 16 at p: is it a letter / could it start a word (letter, digit or non-ASCII)
+	inline unsigned letterBits(const char *p)
+	{
+		__m128i bytes {_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))};
+		__m128i offset {_mm_xor_si128(_mm_sub_epi8(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), _mm_set1_epi8('a')), _mm_set1_epi8(static_cast<char>(0x80)))};
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmplt_epi8(offset, _mm_set1_epi8(static_cast<char>(0x80 + 26)))));
+	}
+
+	inline unsigned startBits(const char *p)
+	{
+		__m128i bytes {_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))};
+		__m128i digit {_mm_cmplt_epi8(_mm_xor_si128(_mm_sub_epi8(bytes, _mm_set1_epi8('0')), _mm_set1_epi8(static_cast<char>(0x80))), _mm_set1_epi8(static_cast<char>(0x80 + 10)))};
+		unsigned high {static_cast<unsigned>(_mm_movemask_epi8(bytes))};
+		return letterBits(p) | static_cast<unsigned>(_mm_movemask_epi8(digit)) | high;
+	}
+#endif
+
+	// index of the first byte at or after i that could start a word (letter, digit or non-ASCII)
+	inline std::size_t skipGap(const char *data, std::size_t i, std::size_t size)
+	{
+#ifdef __SSE2__
+		for (; i + 16 <= size; i += 16)
+		{
+			if (unsigned bits {startBits(data + i)}) return i + __builtin_ctz(bits);
+		}
+#endif
+		while (i < size && (byteClass(data[i]) == Gap || byteClass(data[i]) == Apostrophe)) ++i;
+		return i;
+	}
+
+	// index of the first non-letter at or after i
+	inline std::size_t skipLetters(const char *data, std::size_t i, std::size_t size)
+	{
+#ifdef __SSE2__
+		for (; i + 16 <= size; i += 16)
+		{
+			if (unsigned bits {~letterBits(data + i) & 0xFFFFu}) return i + __builtin_ctz(bits);
+		}
+#endif
+		while (i < size && byteClass(data[i]) == Letter) ++i;
+		return i;
+	}
+
+	// walks text one word at a time, handing out views into it (nothing is copied)
+	class Tokenizer
+	{
+	public:
+		explicit Tokenizer(std::string_view text) : m_data{text.data()}, m_size{text.size()} {}
+
+		bool next(std::string_view &word)
+		{
+			while (true)
+			{
+				m_at = skipGap(m_data, m_at, m_size);
+				if (m_at == m_size) return false;
+
+				std::size_t start {m_at};
+				bool skip {false};
+				while (true)
+				{
+					m_at = skipLetters(m_data, m_at, m_size); // the rest of this run of letters
+					if (m_at == m_size) break;
+
+					std::uint8_t type {byteClass(m_data[m_at])};
+					if (type == Other) skip = true; // numbers, "mp3", "café": not ours to judge
+					else if (!(type == Apostrophe && m_at + 1 < m_size && byteClass(m_data[m_at + 1]) == Letter)) break; // "don't" goes on
+					++m_at;
+				}
+
+				if (skip) continue;
+				word = std::string_view{m_data + start, m_at - start};
+				return true;
+			}
+		}
+
+	private:
+		const char *m_data;
+		std::size_t m_size;
+		std::size_t m_at {0};
+	};
+}
 
 SpellChecker::SpellChecker(const Dictionary &dict) : m_dict{dict} {}
 
 bool SpellChecker::check(std::string_view word) const
 {
 	// returns false if word is mispelled or not found in dictionary
+	// one cache line instead of a trie descent, while the filter still knows every word
+	if (m_filterGeneration == m_dict.generation() && !m_filter.mayContain(word)) return false;
 	return (!m_dict.search(word) ? false : true);
 }
 
+std::vector<SpellChecker::Misspelling> SpellChecker::checkDocument(std::string_view text, bool withCorrections) const
+{
+	std::vector<Misspelling> results;
+	checkRange(text, 0, text.size(), withCorrections, results);
+	return results;
+}
+
+std::vector<SpellChecker::Misspelling> SpellChecker::checkDocument(std::string_view text, ThreadPool &pool, bool withCorrections) const
+{
+	// a few chunks per worker, so stealing can even out uneven ones
+	std::size_t chunks {std::max<std::size_t>(1, std::min<std::size_t>(4 * pool.size(), text.size() / dct::g_checkChunk))};
+
+	// cut points moved forward to the next gap, so no word straddles two chunks
+	std::vector<std::size_t> cuts {0};
+	for (std::size_t i{1}; i < chunks; ++i)
+	{
+		std::size_t cut {std::max(cuts.back(), text.size() * i / chunks)};
+		while (cut < text.size() && byteClass(text[cut]) != Gap) ++cut;
+		cuts.push_back(cut);
+	}
+	cuts.push_back(text.size());
+
+	// what one chunk knows about its words
+	struct Piece
+	{
+		WordTable m_seen; // its distinct words
+		std::vector<std::uint32_t> m_ids; // m_seen index of its k-th word
+		std::vector<std::vector<std::uint32_t>> m_byShard; // its distinct words, by shard
+		std::vector<std::uint64_t> m_global; // (shard << 32 | index in that shard) per distinct word
+		std::vector<Misspelling> m_found;
+	};
+
+	// distinct words are split across shards by hash, so merging and checking them is parallel too
+	std::size_t shards {4 * static_cast<std::size_t>(pool.size())};
+	std::vector<Piece> pieces(chunks);
+	std::vector<WordTable> all(shards);
+	std::vector<std::vector<std::uint8_t>> spelled(shards); // bytes rather than vector<bool>, so no two tasks ever write the same word
+	std::vector<std::vector<std::vector<std::string>>> corrections(shards);
+	ThreadPool::TaskGroup tasks {pool}; // after everything its tasks touch, so it is gone first
+
+	// 1. each chunk tokenizes and dedups its own text
+	for (std::size_t c{0}; c < chunks; ++c)
+	{
+		tasks.submit([&, c]()
+		{
+			Piece &piece {pieces[c]};
+			Tokenizer tokens {text.substr(cuts[c], cuts[c + 1] - cuts[c])};
+			bool added {false};
+			for (std::string_view word; tokens.next(word);) piece.m_ids.push_back(piece.m_seen.intern(word, added));
+
+			piece.m_byShard.resize(shards);
+			piece.m_global.resize(piece.m_seen.size());
+			for (std::uint32_t w{0}; w < piece.m_seen.size(); ++w) piece.m_byShard[WordTable::hash(piece.m_seen.word(w)) % shards].push_back(w);
+		});
+	}
+	tasks.wait();
+
+	// 2. each shard merges its words from every chunk, then checks (and corrects) each once
+	for (std::size_t s{0}; s < shards; ++s)
+	{
+		tasks.submit([&, s]()
+		{
+			bool added {false};
+			for (Piece &piece : pieces)
+			{
+				for (std::uint32_t w : piece.m_byShard[s]) piece.m_global[w] = static_cast<std::uint64_t>(s) << 32 | all[s].intern(piece.m_seen.word(w), added);
+			}
+
+			spelled[s].resize(all[s].size());
+			if (withCorrections) corrections[s].resize(all[s].size());
+			for (std::uint32_t w{0}; w < all[s].size(); ++w)
+			{
+				spelled[s][w] = check(all[s].word(w));
+				if (withCorrections && !spelled[s][w]) corrections[s][w] = correct(all[s].word(w));
+			}
+		});
+	}
+	tasks.wait();
+
+	// 3. each chunk walks its words again and reports the misspelled ones
+	for (std::size_t c{0}; c < chunks; ++c)
+	{
+		tasks.submit([&, c]()
+		{
+			Piece &piece {pieces[c]};
+			Tokenizer tokens {text.substr(cuts[c], cuts[c + 1] - cuts[c])};
+			std::size_t k {0};
+			for (std::string_view word; tokens.next(word); ++k)
+			{
+				std::uint64_t global {piece.m_global[piece.m_ids[k]]};
+				std::size_t s {static_cast<std::size_t>(global >> 32)}, w {static_cast<std::size_t>(global & UINT32_MAX)};
+				if (spelled[s][w]) continue;
+
+				Misspelling miss;
+				miss.m_offset = static_cast<std::size_t>(word.data() - text.data());
+				miss.m_length = word.size();
+				if (withCorrections) miss.m_corrections = corrections[s][w];
+				piece.m_found.push_back(std::move(miss));
+			}
+		});
+	}
+	tasks.wait();
+
+	std::size_t total {0};
+	for (const auto &piece : pieces) total += piece.m_found.size();
+
+	std::vector<Misspelling> results;
+	results.reserve(total);
+	for (auto &piece : pieces) std::move(piece.m_found.begin(), piece.m_found.end(), std::back_inserter(results));
+	return results;
+}
+
+std::vector<bool> SpellChecker::checkBatch(const std::vector<std::string_view> &words) const
+{
+	std::vector<bool> results(words.size());
+
+	WordTable seen;
+	std::vector<bool> spelled;
+	for (std::size_t i{0}; i < words.size(); ++i)
+	{
+		bool added {false};
+		std::uint32_t id {seen.intern(words[i], added)};
+		if (added) spelled.push_back(check(words[i]));
+		results[i] = spelled[id];
+	}
+	return results;
+}
+
 std::vector<std::string> SpellChecker::suggest(std::string_view prefix) const 
 { 
 	std::vector<std::string> results;
@@ -21,15 +358,139 @@ std::vector<std::string> SpellChecker::suggest(std::string_view prefix) const
 }
 
 std::vector<std::string> SpellChecker::correct(std::string_view word) const 
-{ // implement
+{
 	std::vector<std::string> results;
+
+	if (m_dict.isEmpty()) return results;
+
+	if (word.empty()) return results;
+
+	// ranked by edit distance (a correctly spelled word comes back first)
+	if (m_engine == Engine::TrieWalk)
+	{
+		m_dict.suggestCorrections(word, results, dct::g_maxSuggest);
+		return results;
+	}
+
+	dct::NormalizedWord cleanWord {word};
+	if (cleanWord.empty()) return results;
+
+	std::vector<std::pair<std::string, int>> candidates;
+	if (m_engine == Engine::SymSpell) m_symSpell.lookup(cleanWord.view(), dct::g_maxEdit, candidates);
+	else m_bkTree.lookup(cleanWord.view(), dct::g_maxEdit, candidates);
+	dct::rankCandidates(candidates, results, dct::g_maxSuggest);
+
 	return results;
 }
 
+void SpellChecker::setEngine(Engine engine)
+{
+	m_engine = engine;
+
+	// only the selected engine keeps an index, the others give their memory back
+	m_symSpell.clear();
+	m_bkTree.clear();
+	if (engine == Engine::TrieWalk) return;
+
+	std::vector<std::string> words;
+	m_dict.getWords(words);
+	if (engine == Engine::SymSpell) m_symSpell.build(words);
+	else m_bkTree.build(words);
+}
+
+SpellChecker::Engine SpellChecker::getEngine() const { return m_engine; }
+
+void SpellChecker::setFilter(bool enabled)
+{
+	if (!enabled)
+	{
+		m_filter.clear();
+		return;
+	}
+
+	m_filterGeneration = m_dict.generation(); // before reading the words, so a word added meanwhile isn't missed
+	std::vector<std::string> words;
+	m_dict.getWords(words);
+	m_filter.build(words);
+}
+
+bool SpellChecker::hasFilter() const { return !m_filter.isEmpty(); }
+
+SpellChecker::FilterStats SpellChecker::filterStats(std::size_t probes) const
+{
+	FilterStats stats;
+	if (m_filter.isEmpty()) return stats;
+
+	stats.m_words = m_filter.size();
+	stats.m_bytes = m_filter.memory();
+	stats.m_expectedRate = m_filter.expectedFalsePositiveRate();
+
+	// random 3-12 letter strings (fixed seed, so runs compare); the few real words among them don't count
+	dct::XorShift next {0x9e3779b97f4a7c15ull};
+
+	std::size_t passed {0};
+	std::string probe;
+	for (std::size_t i{0}; i < probes; ++i)
+	{
+		probe.assign(3 + next() % 10, 'a');
+		for (char &c : probe) c = static_cast<char>('a' + next() % dct::g_alpha);
+		if (m_dict.search(probe)) continue;
+
+		++stats.m_probes;
+		passed += m_filter.mayContain(probe);
+	}
+	if (stats.m_probes) stats.m_measuredRate = static_cast<double>(passed) / stats.m_probes;
+	return stats;
+}
+
 std::string SpellChecker::autofill(std::string_view word) const 
-{ // implement
-	std::string result {word};
-	return result;
+{
+	Trie::Cursor cursor {m_dict.getCursor()};
+	for (char c : word) cursor.push(c);
+
+	std::string result {cursor.best()};
+	return result.empty() ? std::string{word} : result;
+}
+
+SpellChecker::Session SpellChecker::startSession() const { return Session{m_dict}; }
+
+SpellChecker::Session::Session(const Dictionary &dict) : m_cursor{dict.getCursor()}, m_completions(1) {}
+
+const std::string &SpellChecker::Session::type(char c)
+{
+	std::size_t letters {m_cursor.prefix().size()};
+	m_cursor.push(c);
+
+	// a keystroke that adds no letter can't change the answer
+	if (m_cursor.prefix().size() == letters) m_completions.push_back(m_completions.back());
+	else m_completions.push_back(m_cursor.best());
+
+	return m_completions.back();
+}
+
+const std::string &SpellChecker::Session::backspace()
+{
+	if (m_completions.size() > 1)
+	{
+		m_cursor.pop();
+		m_completions.pop_back();
+	}
+	return m_completions.back();
+}
+
+void SpellChecker::Session::clear()
+{
+	m_cursor.reset();
+	m_completions.resize(1);
+}
+
+const std::string &SpellChecker::Session::completion() const { return m_completions.back(); }
+
+std::string SpellChecker::Session::ghost() const
+{
+	const std::string &best {completion()};
+	std::size_t typed {m_cursor.prefix().size()};
+	return best.size() > typed ? best.substr(typed) : "";
 }
 
 void SpellChecker::printSuggest(const std::vector<std::string> &out) const
@@ -46,3 +507,41 @@ void SpellChecker::printSuggest(const std::vector<std::string> &out) const
 		}
 	}
 }
+
+/*********************************
+// SpellChecker Helper Functions
+**********************************/
+void SpellChecker::checkRange(std::string_view text, std::size_t begin, std::size_t end, bool withCorrections, std::vector<Misspelling> &out) const
+{
+	// one check (and one correction) per distinct word, however often it repeats
+	WordTable seen;
+	std::vector<bool> spelled;
+	std::vector<std::vector<std::string>> corrections;
+	std::vector<bool> corrected;
+
+	Tokenizer tokens {text.substr(begin, end - begin)};
+	std::string_view word;
+	while (tokens.next(word))
+	{
+		bool added {false};
+		std::uint32_t id {seen.intern(word, added)};
+		if (added)
+		{
+			spelled.push_back(check(word));
+			corrected.push_back(false);
+		}
+		if (spelled[id]) continue;
+
+		Misspelling miss;
+		miss.m_offset = static_cast<std::size_t>(word.data() - text.data());
+		miss.m_length = word.size();
+		if (withCorrections)
+		{
+			if (corrections.size() < spelled.size()) corrections.resize(spelled.size());
+			if (!corrected[id]) corrections[id] = correct(word);
+			corrected[id] = true;
+			miss.m_corrections = corrections[id];
+		}
+		out.push_back(std::move(miss));
+	}
+}
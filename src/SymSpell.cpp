@@ -0,0 +1,214 @@
+#include "SymSpell.h"
+#include "EditDistance.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+SymSpell::SymSpell(int maxDistance, std::size_t prefixLength) 
+	: m_maxDistance{maxDistance}, m_prefixLength{prefixLength}
+{
+	clear();
+}
+
+void SymSpell::build(const std::vector<std::string> &words)
+{
+	clear();
+
+	// (hash << 32 | word index) for every distinct delete of every word; sorting groups postings by key
+	std::vector<std::uint64_t> pairs;
+	std::vector<std::uint32_t> hashes;
+	m_offsets.reserve(words.size() + 1);
+
+	for (const auto &word : words)
+	{
+		auto index {static_cast<std::uint32_t>(m_offsets.size() - 1)};
+		m_text += word;
+		m_offsets.push_back(static_cast<std::uint32_t>(m_text.size()));
+
+		deletes(word, m_maxDistance, hashes);
+		for (std::uint32_t key : hashes) pairs.push_back(static_cast<std::uint64_t>(key) << 32 | index);
+	}
+
+	std::sort(pairs.begin(), pairs.end());
+	m_postings.reserve(pairs.size());
+
+	for (std::uint64_t pair : pairs)
+	{
+		auto key {static_cast<std::uint32_t>(pair >> 32)};
+		if (m_keys.empty() || m_keys.back() != key)
+		{
+			m_keys.push_back(key);
+			m_starts.push_back(static_cast<std::uint32_t>(m_postings.size()));
+		}
+		m_postings.push_back(static_cast<std::uint32_t>(pair));
+	}
+	m_starts.push_back(static_cast<std::uint32_t>(m_postings.size()));
+
+	// directory over the top bits of the sorted keys
+	m_directory.assign((1u << m_directoryBits) + 1, 0);
+	std::size_t k {0};
+	for (std::uint32_t bucket{0}; bucket <= (1u << m_directoryBits); ++bucket)
+	{
+		while (k < m_keys.size() && (m_keys[k] >> (32 - m_directoryBits)) < bucket) ++k;
+		m_directory[bucket] = static_cast<std::uint32_t>(k);
+	}
+
+	m_text.shrink_to_fit();
+	m_keys.shrink_to_fit();
+	m_starts.shrink_to_fit();
+}
+
+bool SymSpell::loadFile(const std::string &filename)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		std::cerr << "Error: could not open " << filename << '\n';
+		return false;
+	}
+
+	std::vector<std::string> words;
+	std::string word;
+	while (std::getline(file, word))
+	{
+		if (!word.empty() && word.back() == '\r') word.pop_back();
+		if (!word.empty()) words.push_back(word);
+	}
+
+	build(words);
+	return true;
+}
+
+void SymSpell::clear()
+{
+	m_text.clear();
+	m_offsets.assign(1, 0);
+	m_keys.clear();
+	m_starts.clear();
+	m_postings.clear();
+	m_directory.clear();
+}
+
+void SymSpell::lookup(std::string_view word, int maxDistance, std::vector<std::pair<std::string, int>> &out) const
+{
+	if (isEmpty() || word.empty()) return;
+	maxDistance = std::min(maxDistance, m_maxDistance);
+
+	std::vector<std::uint32_t> hashes;
+	deletes(word, maxDistance, hashes);
+
+	// gather every word posted under one of the query's deletes, once each
+	std::vector<std::uint32_t> candidates;
+	for (std::uint32_t key : hashes)
+	{
+		std::uint32_t first, last;
+		if (findKey(key, first, last)) candidates.insert(candidates.end(), m_postings.begin() + first, m_postings.begin() + last);
+	}
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	// shared keys only say the prefixes are close, so check the whole word (a batch at a time)
+	std::vector<std::string_view> texts;
+	texts.reserve(candidates.size());
+	for (std::uint32_t index : candidates)
+	{
+		std::string_view candidate {wordAt(index)};
+		int lengthGap {static_cast<int>(candidate.size()) - static_cast<int>(word.size())};
+		if (lengthGap <= maxDistance && -lengthGap <= maxDistance) texts.push_back(candidate);
+	}
+
+	std::vector<int> distances(texts.size());
+	dct::EditPattern{word}.distances(texts.data(), texts.size(), distances.data());
+	for (std::size_t i{0}; i < texts.size(); ++i)
+	{
+		if (distances[i] <= maxDistance) out.emplace_back(texts[i], distances[i]);
+	}
+}
+
+bool SymSpell::isEmpty() const { return m_offsets.size() == 1; }
+
+std::size_t SymSpell::size() const { return m_offsets.size() - 1; }
+
+int SymSpell::maxDistance() const { return m_maxDistance; }
+
+void SymSpell::memoryReport(std::ostream &out) const
+{
+	std::size_t words {size()};
+	std::size_t bytes {m_text.capacity() + (m_offsets.capacity() + m_keys.capacity() + m_starts.capacity() 
+		+ m_postings.capacity() + m_directory.capacity()) * sizeof(std::uint32_t)};
+
+	out << "words: " << words << " (prefix " << m_prefixLength << ", distance " << m_maxDistance << ")\n"
+		<< "keys: " << m_keys.size() << " (" << m_postings.size() << " postings)\n"
+		<< "symspell: " << bytes << " bytes";
+	if (words) out << " (" << static_cast<double>(bytes) / words << " bytes/word)";
+	out << '\n';
+}
+
+/*********************************
+// SymSpell Helper Functions
+*********************************/
+std::string_view SymSpell::wordAt(std::uint32_t index) const
+{
+	return std::string_view{m_text}.substr(m_offsets[index], m_offsets[index + 1] - m_offsets[index]);
+}
+
+void SymSpell::deletes(std::string_view word, int maxDistance, std::vector<std::uint32_t> &hashes) const
+{
+	// hashes of the prefix itself and of everything up to maxDistance deletes away from it
+	hashes.clear();
+	std::string prefix {m_prefixLength ? word.substr(0, m_prefixLength) : word};
+	hashes.push_back(hash(prefix));
+	deletes(prefix, maxDistance, hashes);
+
+	std::sort(hashes.begin(), hashes.end());
+	hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+}
+
+void SymSpell::deletes(std::string &word, int remaining, std::vector<std::uint32_t> &hashes) const
+{
+	if (remaining == 0 || word.empty()) return; // down to "", the key every word of up to maxDistance letters shares
+
+	for (std::size_t i{0}; i < word.size(); ++i)
+	{
+		// deleting either letter of a doubled pair gives the same string, skip the repeat
+		if (i > 0 && word[i] == word[i - 1]) continue;
+
+		char letter {word[i]};
+		word.erase(i, 1);
+		hashes.push_back(hash(word));
+		deletes(word, remaining - 1, hashes);
+		word.insert(word.begin() + i, letter); // backtrack
+	}
+}
+
+bool SymSpell::findKey(std::uint32_t hash, std::uint32_t &first, std::uint32_t &last) const
+{
+	std::uint32_t bucket {hash >> (32 - m_directoryBits)};
+	auto begin {m_keys.begin() + m_directory[bucket]};
+	auto end {m_keys.begin() + m_directory[bucket + 1]};
+
+	auto it {std::lower_bound(begin, end, hash)};
+	if (it == end || *it != hash) return false;
+
+	std::size_t k {static_cast<std::size_t>(it - m_keys.begin())};
+	first = m_starts[k];
+	last = m_starts[k + 1];
+	return true;
+}
+
+std::uint32_t SymSpell::hash(std::string_view key)
+{
+	// FNV-1a, then a murmur finalizer so the top bits (used by the directory) are well mixed
+	std::uint32_t h {2166136261u};
+	for (char c : key)
+	{
+		h ^= static_cast<unsigned char>(c);
+		h *= 16777619u;
+	}
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
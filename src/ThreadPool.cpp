@@ -0,0 +1,172 @@
+#include "ThreadPool.h"
+
+namespace
+{
+	// which pool and worker the current thread is, so submit() from a task stays local
+	thread_local const ThreadPool *t_pool {nullptr};
+	thread_local unsigned t_worker {0};
+}
+
+ThreadPool::ThreadPool(unsigned threads)
+{
+	if (threads == 0) threads = std::thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	for (unsigned i{0}; i < threads; ++i) m_queues.push_back(std::make_unique<Queue>());
+	for (unsigned i{0}; i < threads; ++i) m_threads.emplace_back([this, i]() { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock {m_mutex};
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (auto &thread : m_threads) thread.join();
+}
+
+ThreadPool::TaskGroup::~TaskGroup() { drain(); }
+
+void ThreadPool::TaskGroup::submit(std::function<void()> task)
+{
+	++m_pending;
+	m_pool.submit([this, task = std::move(task)]()
+	{
+		try
+		{
+			task();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock {m_pool.m_mutex};
+			if (!m_error) m_error = std::current_exception();
+		}
+
+		// the group may be gone the moment a waiter sees 0, so nothing of it is touched after
+		ThreadPool &pool {m_pool};
+		std::lock_guard<std::mutex> lock {pool.m_mutex};
+		if (--m_pending == 0) pool.m_done.notify_all();
+	});
+}
+
+void ThreadPool::TaskGroup::wait()
+{
+	drain();
+
+	std::lock_guard<std::mutex> lock {m_pool.m_mutex};
+	if (m_error)
+	{
+		std::exception_ptr error {m_error};
+		m_error = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+void ThreadPool::TaskGroup::drain()
+{
+	unsigned self {m_pool.self()};
+	while (m_pending.load() > 0)
+	{
+		if (m_pool.runOne(self)) continue;
+
+		// nothing left to take, the rest is running on other threads
+		std::unique_lock<std::mutex> lock {m_pool.m_mutex};
+		m_pool.m_done.wait(lock, [this] { return m_pending.load() == 0 || m_pool.m_queued > 0; });
+	}
+}
+
+unsigned ThreadPool::size() const { return static_cast<unsigned>(m_queues.size()); }
+
+std::size_t ThreadPool::steals() const { return m_steals.load(); }
+
+/*********************************
+// ThreadPool Helper Functions
+*********************************/
+void ThreadPool::submit(std::function<void()> task)
+{
+	unsigned target {self()};
+	if (target == size()) target = m_next++ % size();
+
+	// counted before it is queued, so a take() can never get to it first and count it down past 0
+	{
+		std::lock_guard<std::mutex> lock {m_mutex};
+		++m_queued;
+	}
+	{
+		std::lock_guard<std::mutex> lock {m_queues[target]->m_mutex};
+		m_queues[target]->m_tasks.push_back(std::move(task));
+	}
+
+	// under m_mutex, so nobody can check for work and then miss this wakeup
+	std::lock_guard<std::mutex> lock {m_mutex};
+	m_wake.notify_one();
+	m_done.notify_all(); // waiting groups help out too
+}
+
+void ThreadPool::workerLoop(unsigned self)
+{
+	t_pool = this;
+	t_worker = self;
+
+	while (true)
+	{
+		if (runOne(self)) continue;
+
+		std::unique_lock<std::mutex> lock {m_mutex};
+		m_wake.wait(lock, [this] { return m_stop || m_queued > 0; });
+		if (m_stop && m_queued == 0) return;
+	}
+}
+
+unsigned ThreadPool::self() const { return t_pool == this ? t_worker : size(); }
+
+bool ThreadPool::runOne(unsigned self)
+{
+	std::function<void()> task;
+	if (!take(self, task)) return false;
+
+	task(); // a group's wrapper, which catches
+	return true;
+}
+
+bool ThreadPool::take(unsigned self, std::function<void()> &task)
+{
+	bool found {false};
+
+	// own queue first, newest task
+	if (self < size())
+	{
+		Queue &own {*m_queues[self]};
+		std::lock_guard<std::mutex> lock {own.m_mutex};
+		if (!own.m_tasks.empty())
+		{
+			task = std::move(own.m_tasks.back());
+			own.m_tasks.pop_back();
+			found = true;
+		}
+	}
+
+	// then the oldest task of the next worker that has one
+	for (unsigned i{1}; !found && i <= size(); ++i)
+	{
+		unsigned victim {(self + i) % size()};
+		if (victim == self) continue;
+
+		Queue &other {*m_queues[victim]};
+		std::lock_guard<std::mutex> lock {other.m_mutex};
+		if (other.m_tasks.empty()) continue;
+
+		task = std::move(other.m_tasks.front());
+		other.m_tasks.pop_front();
+		found = true;
+		if (self < size()) ++m_steals;
+	}
+
+	if (!found) return false;
+
+	std::lock_guard<std::mutex> lock {m_mutex};
+	--m_queued;
+	if (m_queued > 0) m_wake.notify_one(); // more work than the one woken for it
+	return true;
+}
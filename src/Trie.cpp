@@ -1,13 +1,67 @@
 #include "Trie.h"
 #include "Utils.h"
+#include "Normalize.h"
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
 
-Trie::Trie() : m_root{new TrieNode()} {}
+namespace
+{
+	// on-disk layout: header, then the node array, the edge array and the completion table
+	// (entries including the sentinel, word refs, text)
+	struct ImageHeader
+	{
+		char m_magic[8];
+		std::uint32_t m_version;
+		std::uint32_t m_nodeCount;
+		std::uint32_t m_edgeCount;
+		std::uint32_t m_topEntryCount; // completion table (version 3), after the edges
+		std::uint32_t m_topWordCount;
+		std::uint32_t m_topTextSize;
+		std::uint32_t m_topLimit;
+		std::uint32_t m_topDepth; // the rules the table was built with (version 5)
+		std::uint32_t m_topMinWords;
+		std::uint64_t m_stamp; // caller supplied, lets the owner detect a stale image
+		std::uint64_t m_checksum; // over everything after the header
+	};
 
-Trie::~Trie() { deleteTrie(m_root); }
+	constexpr char g_imageMagic[8] {'D', 'C', 'T', 'T', 'R', 'I', 'E', '\0'};
+	constexpr std::uint32_t g_imageVersion {5}; // 2: nodes carry word scores, 3: completion table, 4: form nodes, 5: table rules
+
+	// FNV-1a folded over 64 bit words (tail bytes one at a time)
+	std::uint64_t checksum(const char *data, std::size_t size)
+	{
+		std::uint64_t hash {14695981039346656037ull};
+		std::size_t i {0};
+		for (; i + 8 <= size; i += 8)
+		{
+			std::uint64_t word;
+			std::memcpy(&word, data + i, 8);
+			hash = (hash ^ word) * 1099511628211ull;
+		}
+		for (; i < size; ++i) hash = (hash ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+		return hash;
+	}
+
+	// writes take normalized words, checked whole before any node is added, so a bad
+	// letter can't leave a wordless chain behind (normalize() should have removed it)
+	bool isLetters(std::string_view word)
+	{
+		return std::all_of(word.begin(), word.end(), [](char c) { return c >= 'a' && c <= 'z'; });
+	}
+}
+
+Trie::Trie() { clear(); }
 
 bool Trie::insert(std::string_view word, int word_id)
 {
-    TrieNode *node {m_root};
+    if (!isLetters(word)) return false;
+    detach(); // first write to a mapped image copies it into the arena
+
+    std::uint32_t node {m_nil}; // root
 
     // traverse to the last node in the word
     for (char c : word)
@@ -15,48 +69,211 @@ bool Trie::insert(std::string_view word, int word_id)
         int index {c - 'a'}; 
 
         // check if there is an existing child node
-        if (!node->m_children[index]) 
-		{
-            node->m_children[index] = new TrieNode();
-        }
-        node = node->m_children[index];
+        std::uint32_t next {child(node, index)};
+        if (next == m_nil) next = addChild(node, index);
+        node = next;
     }
 
     // check if word is already in Trie (node is last letter of the word)
-    if (node->m_isEndOfWord) return false;
+    if (m_nodes[node].m_isEndOfWord && !m_nodes[node].m_isForm) return false;
 
-    node->m_isEndOfWord = true;
-	node->m_wordID = word_id;
+    m_nodes[node].m_isEndOfWord = true;
+	m_nodes[node].m_isForm = false;
+	m_nodes[node].m_wordID = word_id;
+	refreshTopRows(word);
     return true;
 }
 
-bool Trie::remove(std::string &word) { return remove(m_root, word); }
+bool Trie::insertForm(std::string_view form, int lemma_id)
+{
+	if (!isLetters(form)) return false;
+	detach();
+
+	std::uint32_t node {m_nil};
+	for (char c : form)
+	{
+		int index {c - 'a'};
+		std::uint32_t next {child(node, index)};
+		if (next == m_nil) next = addChild(node, index);
+		node = next;
+	}
+
+	// a lemma keeps its own id ("saw" stays a word, not a form of "see"), and the first lemma claiming a form keeps it
+	if (m_nodes[node].m_isEndOfWord) return false;
+
+	m_nodes[node].m_isEndOfWord = true;
+	m_nodes[node].m_isForm = true;
+	m_nodes[node].m_wordID = lemma_id;
+	refreshTopRows(form);
+	return true;
+}
+
+Trie::Loader::Loader(Trie &trie) : m_trie{trie}, m_path{m_nil}
+{
+	m_trie.detach();
+	m_trie.clearTopTable(); // a bulk load, the table is rebuilt afterwards rather than row by row
+}
+
+bool Trie::Loader::add(std::string_view word, int word_id)
+{
+	if (!isLetters(word)) return false;
+
+	// reuse the nodes shared with the previous word (any order is correct, sorted order makes it cheap)
+	std::size_t common {0};
+	while (common < word.size() && common < m_lastWord.size() && word[common] == m_lastWord[common]) ++common;
+	m_path.resize(common + 1);
+	m_lastWord.assign(word.substr(0, common));
+
+	for (std::size_t i{common}; i < word.size(); ++i)
+	{
+		int index {word[i] - 'a'};
+		std::uint32_t node {m_path.back()};
+		std::uint32_t next {m_trie.child(node, index)};
+		if (next == m_nil) next = m_trie.addChild(node, index);
+
+		m_path.push_back(next);
+		m_lastWord.push_back(word[i]);
+	}
+
+	TrieNode &node {m_trie.m_nodes[m_path.back()]};
+	if (node.m_isEndOfWord && !node.m_isForm) return false; // word is already in the trie
+
+	node.m_isEndOfWord = true;
+	node.m_isForm = false;
+	node.m_wordID = word_id;
+	return true;
+}
+
+Trie::Cursor::Cursor(const Trie &trie) : m_trie{trie} { reset(); }
+
+void Trie::Cursor::push(char c)
+{
+	Step step {m_path.back()};
+	int index {dct::letterIndex(c)};
+	step.m_isLetter = index >= 0;
+
+	if (step.m_isLetter)
+	{
+		m_prefix.push_back(static_cast<char>('a' + index));
+
+		// one descent from where the last keystroke left off
+		if (step.m_node != m_dead)
+		{
+			step.m_node = m_trie.child(step.m_node, index);
+			if (step.m_node == m_nil) step.m_node = m_dead;
+		}
+	}
+
+	m_path.push_back(step);
+}
+
+void Trie::Cursor::pop()
+{
+	if (m_path.size() == 1) return; // nothing typed
+
+	if (m_path.back().m_isLetter) m_prefix.pop_back();
+	m_path.pop_back();
+}
+
+void Trie::Cursor::reset()
+{
+	m_path.assign(1, Step{m_nil, false});
+	m_prefix.clear();
+}
+
+bool Trie::Cursor::isValid() const { return m_path.back().m_node != m_dead; }
+
+bool Trie::Cursor::isWord() const { return isValid() && !m_prefix.empty() && m_trie.nodeAt(m_path.back().m_node).m_isEndOfWord; }
+
+std::string_view Trie::Cursor::prefix() const { return m_prefix; }
+
+std::string Trie::Cursor::best() const
+{
+	if (!isValid() || m_prefix.empty()) return "";
+
+	std::string word {m_prefix};
+	m_trie.bestWord(m_path.back().m_node, word);
+	return word;
+}
+
+bool Trie::remove(std::string_view word) 
+{ 
+	detach();
+
+	// the nodes on word's path, any the removal frees take their table rows with them
+	std::vector<std::uint32_t> path;
+	for (std::uint32_t node {m_nil}; hasTopTable() && path.size() < word.size(); path.push_back(node))
+	{
+		int index {word[path.size()] - 'a'};
+		if (index < 0 || index >= dct::g_alpha || (node = child(node, index)) == m_nil) break;
+	}
+
+	if (!remove(m_nil, word)) return false;
+	refreshTopRows(word, path);
+	return true;
+}
 
 bool Trie::contains(std::string_view word) const
 {
-    TrieNode *node {m_root};
+    std::uint32_t node {m_nil};
 
-    // traverse to the last node in the word (DFS)
+    // traverse to the last node in the word (DFS), normalizing on the way
     for (char c : word)
     {
-        int index {c - 'a'};
-        if (!node->m_children[index]) return false; // not found
-        node = node->m_children[index];
+        int index {dct::letterIndex(c)};
+        if (index < 0) continue; // not a letter, normalize() would have dropped it
+
+        node = child(node, index);
+        if (node == m_nil) return false; // not found
     }
 
-    return node->m_isEndOfWord; // word not found
+    return nodeAt(node).m_isEndOfWord; // word not found
+}
+
+int Trie::findID(std::string_view word) const
+{
+	std::uint32_t node {m_nil};
+
+	// the same single descent as contains: a form's node already holds its lemma's id
+	for (char c : word)
+	{
+		int index {dct::letterIndex(c)};
+		if (index < 0) continue;
+
+		node = child(node, index);
+		if (node == m_nil) return -1; // not found
+	}
+
+	return nodeAt(node).m_isEndOfWord ? nodeAt(node).m_wordID : -1;
+}
+
+bool Trie::isForm(std::string_view word) const
+{
+	std::uint32_t node {m_nil};
+	for (char c : word)
+	{
+		int index {dct::letterIndex(c)};
+		if (index < 0) continue;
+
+		node = child(node, index);
+		if (node == m_nil) return false; // not found
+	}
+
+	return nodeAt(node).m_isEndOfWord && nodeAt(node).m_isForm;
 }
 
 bool Trie::startsWith(std::string_view prefix) const
 {
-	const TrieNode *node {m_root};
+	std::uint32_t node {m_nil};
 
 	// DFS
 	for (char c : prefix)
 	{
-		int index {c - 'a'};
-		if (!node || !node->m_children[index]) return false;
-		node = node->m_children[index];
+		int index {dct::letterIndex(c)};
+		if (index < 0) continue;
+
+		node = child(node, index);
+		if (node == m_nil) return false;
 	}
 
 	return true;
@@ -64,39 +281,73 @@ bool Trie::startsWith(std::string_view prefix) const
 
 std::string Trie::getPrefix(std::string_view word) const
 {
-	const TrieNode *node {m_root};
+	std::uint32_t node {m_nil};
 	std::string prefix;
 
 	// DFS
 	for (char c : word)
 	{
-		int index {c - 'a'};
-		if (!node || !node->m_children[index]) break;
+		int index {dct::letterIndex(c)};
+		if (index < 0) continue;
+
+		std::uint32_t next {child(node, index)};
+		if (next == m_nil) break;
 		
-		prefix.push_back(c);
-		node = node->m_children[index];
+		prefix.push_back(static_cast<char>('a' + index));
+		node = next;
 	}
 
 	return prefix;
 }
 
-void Trie::collectWithPrefix(std::string_view prefix, std::vector<std::string> &out, std::size_t limit) const
+void Trie::collectWithPrefix(std::string_view prefix, std::vector<std::string> &out, std::size_t limit, bool withPrefix) const
 {
-	const TrieNode *node {m_root};
-	std::string currentWord;
+	std::uint32_t node {m_nil};
+	std::size_t depth {0};
 
 	// DFS
 	for (char c : prefix)
 	{
-		int index {c - 'a'};
-		if (!node || !node->m_children[index]) return; // prefix not found
+		int index {dct::letterIndex(c)};
+		if (index < 0) continue;
 
-		currentWord.push_back(c);
-		node = node->m_children[index];
+		node = child(node, index);
+		if (node == m_nil) return; // prefix not found
+		++depth;
 	}
 	
-	// build words
-	collectFromNode(node, currentWord, out, limit);
+	if (collectFromTable(node, depth, out, limit, withPrefix)) return; // hot prefix, already ranked
+
+	// only a search builds the word (from the path, so it comes out normalized)
+	collectBest(node, getPrefix(prefix), out, limit, withPrefix);
+}
+
+void Trie::collectAll(std::vector<std::string> &out) const
+{
+	std::string currentWord;
+	collectFromNode(m_nil, currentWord, out, std::numeric_limits<std::size_t>::max());
+}
+
+void Trie::collectEntries(std::vector<WordEntry> &out) const
+{
+	std::string currentWord;
+	collectEntries(m_nil, currentWord, out);
+}
+
+void Trie::collectWithinDistance(std::string_view word, int maxDistance, std::vector<std::pair<std::string, int>> &out) const
+{
+	// one edit distance DP row per trie depth: row d holds the distance from the first
+	// d letters of the current path to every prefix of word (depth can't exceed
+	// word.size() + maxDistance without every cell going over the limit)
+	std::size_t columns {word.size() + 1};
+	std::vector<int> rows((word.size() + maxDistance + 2) * columns);
+	for (std::size_t j{0}; j < columns; ++j) rows[j] = static_cast<int>(j);
+
+	if (nodeAt(m_nil).m_isEndOfWord && static_cast<int>(word.size()) <= maxDistance)
+		out.emplace_back("", static_cast<int>(word.size()));
+
+	std::string currentWord;
+	walkDistance(m_nil, word, maxDistance, rows, currentWord, out);
 }
 
 void Trie::writeAll(std::ostream &out) const
@@ -109,7 +360,7 @@ void Trie::writeAll(std::ostream &out) const
 	}
 
 	std::string currentWord;
-	rewrite(m_root, currentWord, out); // call recursive write function
+	rewrite(m_nil, currentWord, out); // call recursive write function
 }
 
 void Trie::print() const { writeAll(std::cout); } // same as writeAll logic
@@ -117,35 +368,37 @@ void Trie::print() const { writeAll(std::cout); } // same as writeAll logic
 void Trie::dump() const
 {
 	std::cout << "(root)\n";
-    dumpNode(m_root, ""); // call recursive dump node function
+    dumpNode(m_nil, ""); // call recursive dump node function
 }
 
 void Trie::dumpWord(std::string_view word) const
 {
 	if (!contains(word)) return;
-	const TrieNode *node {m_root};
-	if (!node) return;
+	std::uint32_t node {m_nil};
 
 	std::cout << "(root)\n";
 	size_t depth {0};
 
 	for (char c : word) 
 	{
-		int index {c - 'a'};
+		int index {dct::letterIndex(c)};
+		if (index < 0) continue;
+		c = static_cast<char>('a' + index);
+		std::uint32_t next {child(node, index)};
 
 		// print graphics
-		if (!node->m_children[index])
+		if (next == m_nil)
 		{
 			std::cout << std::string(depth * 4, ' ') 
 				<< "└── " << c << "(missing)\n";
 			return;
 		}
 
-		node = node->m_children[index];
+		node = next;
 
 		std::cout << std::string(depth * 4, ' ') 
 			<< "└── " << c; 
-		if (node->m_isEndOfWord) std::cout << " *";
+		if (nodeAt(node).m_isEndOfWord) std::cout << (nodeAt(node).m_isForm ? " ~" : " *"); // ~ marks a form
 
 		std::cout << '\n';
 		++depth;
@@ -154,148 +407,1031 @@ void Trie::dumpWord(std::string_view word) const
 
 void Trie::clear()
 {
-	deleteTrie(m_root);
-	m_root = new TrieNode(); // initalize new root
+	// release the whole arena at once instead of freeing node by node
+	std::vector<TrieNode>().swap(m_nodes);
+	std::vector<std::uint32_t>().swap(m_edges);
+	m_freeNodes = m_nil;
+	m_freeEdges.fill(0);
+	clearTopTable();
+	m_image.close();
+
+	m_nodes.emplace_back(); // initalize new root
+	m_edges.push_back(0); // reserve block 0 so it can mark an empty free list
+	syncView();
 }
 
-bool Trie::isEmpty() const
+bool Trie::setShard(char letter, const Trie &shard)
 {
-	if (!m_root) return true;
-	if (m_root->m_isEndOfWord) return false;
+	int index {letter - 'a'};
+	if (index < 0 || index >= dct::g_alpha) return false;
+
+	detach();
 
+	dropShard(index); // first, so the copy reuses its nodes and blocks
+
+	std::uint32_t source {shard.child(m_nil, index)};
+	if (source != m_nil) copySubtree(addChild(m_nil, index), shard, source);
+
+	refreshMaxScore(m_nil);
+	if (hasTopTable()) refreshShardRows(index);
+	return true;
+}
+
+void Trie::adoptShards(std::vector<Trie> &shards)
+{
+	detach();
+	clearTopTable();
+
+	// one allocation for all of them, rather than regrowing the arena shard after shard
+	std::size_t nodes {m_nodes.size()}, edges {m_edges.size()};
+	for (const Trie &shard : shards)
+	{
+		nodes += shard.m_nodes.size();
+		edges += shard.m_edges.size();
+	}
+	m_nodes.reserve(nodes);
+	m_edges.reserve(edges);
+	syncView();
+
+	for (std::size_t i{0}; i < shards.size() && i < static_cast<std::size_t>(dct::g_alpha); ++i) adoptShard(static_cast<int>(i), shards[i]);
+}
+
+void Trie::shardReport(std::ostream &out) const
+{
 	for (int i{0}; i < dct::g_alpha; ++i)
 	{
-		if (m_root->m_children[i]) return false;
+		std::uint32_t shard {child(m_nil, i)};
+		if (shard == m_nil) continue;
+
+		std::size_t nodes {0}, edges {0}, words {0};
+		countNodes(shard, nodes, edges, words);
+		out << static_cast<char>('a' + i) << ": " << words << " words, " << nodes << " nodes, "
+			<< nodes * sizeof(TrieNode) + edges * sizeof(std::uint32_t) << " bytes\n";
+	}
+}
+
+bool Trie::isEmpty() const
+{
+	const TrieNode &root {nodeAt(m_nil)};
+	if (root.m_isEndOfWord) return false;
+
+	return !root.hasChildren();
+}
+
+void Trie::memoryReport(std::ostream &out) const
+{
+	std::size_t nodes {0}, edges {0}, words {0};
+	countNodes(m_nil, nodes, edges, words);
+
+	// compact layout: node header + one packed 32 bit index per existing child
+	std::size_t bytes {nodes * sizeof(TrieNode) + edges * sizeof(std::uint32_t)};
+	// reserved arena capacity (includes free lists and growth slack), or the mapped image
+	std::size_t arenaBytes {isMapped() ? m_image.size() 
+		: m_nodes.capacity() * sizeof(TrieNode) + m_edges.capacity() * sizeof(std::uint32_t)};
+	// previous layout: a fixed array of 26 child pointers in every node
+	struct LegacyNode { LegacyNode *m_children[dct::g_alpha]; bool m_isEndOfWord; int m_wordID; };
+	std::size_t legacyBytes {nodes * sizeof(LegacyNode)};
+
+	out << "words: " << words << '\n'
+		<< "nodes: " << nodes << " (" << edges << " edges)\n"
+		<< "compact: " << bytes << " bytes";
+	if (words) out << " (" << static_cast<double>(bytes) / words << " bytes/word)";
+	out << "\narena:   " << arenaBytes << " bytes";
+	if (words) out << " (" << static_cast<double>(arenaBytes) / words << " bytes/word)";
+	out << "\nlegacy:  " << legacyBytes << " bytes";
+	if (words) out << " (" << static_cast<double>(legacyBytes) / words << " bytes/word)";
+	out << '\n';
+
+	if (hasTopTable())
+	{
+		std::size_t topBytes {(m_topEntryCount + 1) * sizeof(TopEntry) + m_topEntryView[m_topEntryCount].m_first * sizeof(TopWord) + m_topTextSize};
+		out << "top table: " << m_topEntryCount << " prefixes (top " << m_topLimit << "), " << topBytes << " bytes\n";
+	}
+}
+
+bool Trie::save(const std::string &filename, std::uint64_t stamp) const
+{
+	// compact into breadth-first order: drops free list holes and keeps the
+	// top levels (touched by every lookup) together at the front of the file
+	std::vector<TrieNode> nodes {nodeAt(m_nil)};
+	std::vector<std::uint32_t> edges {0}; // block 0 stays reserved like in the arena
+	std::vector<std::uint32_t> source {m_nil}; // arena index of each compacted node
+
+	for (std::size_t i{0}; i < nodes.size(); ++i)
+	{
+		TrieNode n {nodeAt(source[i])};
+		if (!n.hasChildren()) continue;
+
+		std::uint32_t block {static_cast<std::uint32_t>(edges.size())};
+		for (int s{0}; s < n.childCount(); ++s)
+		{
+			std::uint32_t old {m_edgeView[n.m_children + s]};
+			edges.push_back(static_cast<std::uint32_t>(nodes.size()));
+			nodes.push_back(nodeAt(old));
+			source.push_back(old);
+		}
+		nodes[i].m_children = block;
+	}
+
+	// the completion table names arena nodes, renumber it to the compacted ones (which reorders it)
+	std::vector<TopEntry> topEntries;
+	std::vector<TopWord> topWords;
+	if (hasTopTable())
+	{
+		std::vector<std::uint32_t> compacted(isMapped() ? m_imageNodes : m_nodes.size(), m_nil);
+		for (std::size_t i{0}; i < source.size(); ++i) compacted[source[i]] = static_cast<std::uint32_t>(i);
+
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> order; // (compacted node, old entry)
+		for (std::uint32_t e{0}; e < m_topEntryCount; ++e) order.emplace_back(compacted[m_topEntryView[e].m_node], e);
+		std::sort(order.begin(), order.end());
+
+		for (const auto &[node, e] : order)
+		{
+			topEntries.push_back(TopEntry{node, static_cast<std::uint32_t>(topWords.size())});
+			topWords.insert(topWords.end(), m_topWordView + m_topEntryView[e].m_first, m_topWordView + m_topEntryView[e + 1].m_first);
+		}
+		topEntries.push_back(TopEntry{UINT32_MAX, static_cast<std::uint32_t>(topWords.size())});
+	}
+
+	std::string payload;
+	payload.append(reinterpret_cast<const char *>(nodes.data()), nodes.size() * sizeof(TrieNode));
+	payload.append(reinterpret_cast<const char *>(edges.data()), edges.size() * sizeof(std::uint32_t));
+	payload.append(reinterpret_cast<const char *>(topEntries.data()), topEntries.size() * sizeof(TopEntry));
+	payload.append(reinterpret_cast<const char *>(topWords.data()), topWords.size() * sizeof(TopWord));
+	if (hasTopTable()) payload.append(m_topTextView, m_topTextSize);
+
+	ImageHeader header {};
+	std::memcpy(header.m_magic, g_imageMagic, sizeof(g_imageMagic));
+	header.m_version = g_imageVersion;
+	header.m_nodeCount = static_cast<std::uint32_t>(nodes.size());
+	header.m_edgeCount = static_cast<std::uint32_t>(edges.size());
+	header.m_topEntryCount = static_cast<std::uint32_t>(topEntries.size());
+	header.m_topWordCount = static_cast<std::uint32_t>(topWords.size());
+	header.m_topTextSize = hasTopTable() ? m_topTextSize : 0;
+	header.m_topLimit = m_topLimit;
+	header.m_topDepth = m_topDepth;
+	header.m_topMinWords = m_topMinWords;
+	header.m_stamp = stamp;
+	header.m_checksum = checksum(payload.data(), payload.size());
+
+	// write next to the target and rename, so processes mapping the old image keep a valid file
+	std::string tmpName {filename + ".tmp"};
+	{
+		std::ofstream out(tmpName, std::ios::binary | std::ios::trunc);
+		if (!out) return false;
+
+		out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+		if (!out) return false;
+	}
+
+	return std::rename(tmpName.c_str(), filename.c_str()) == 0;
+}
+
+bool Trie::load(const std::string &filename, std::uint64_t stamp)
+{
+	MappedFile image;
+	if (!image.open(filename) || image.size() < sizeof(ImageHeader)) return false;
+
+	ImageHeader header;
+	std::memcpy(&header, image.data(), sizeof(header));
+
+	if (std::memcmp(header.m_magic, g_imageMagic, sizeof(g_imageMagic)) != 0) return false;
+	if (header.m_version != g_imageVersion || header.m_stamp != stamp) return false;
+	if (header.m_nodeCount == 0 || header.m_edgeCount == 0) return false;
+
+	std::size_t payloadSize {header.m_nodeCount * sizeof(TrieNode) + header.m_edgeCount * sizeof(std::uint32_t)
+		+ header.m_topEntryCount * sizeof(TopEntry) + header.m_topWordCount * sizeof(TopWord) + header.m_topTextSize};
+	if (image.size() != sizeof(header) + payloadSize) return false;
+
+	const char *payload {image.data() + sizeof(header)};
+	if (checksum(payload, payloadSize) != header.m_checksum) return false;
+
+	// swap the arena for the mapping, queries now read the file in place
+	std::vector<TrieNode>().swap(m_nodes);
+	std::vector<std::uint32_t>().swap(m_edges);
+	m_freeNodes = m_nil;
+	m_freeEdges.fill(0);
+	clearTopTable();
+
+	m_image = std::move(image);
+	m_imageNodes = header.m_nodeCount;
+	m_imageEdges = header.m_edgeCount;
+	if (header.m_topEntryCount > 1) // sentinel only = no table
+	{
+		m_topEntryCount = header.m_topEntryCount - 1;
+		m_topTextSize = header.m_topTextSize;
+		m_topLimit = header.m_topLimit;
+		m_topDepth = header.m_topDepth;
+		m_topMinWords = header.m_topMinWords;
 	}
+	syncView();
+	return true;
+}
+
+bool Trie::isMapped() const { return m_image.isOpen(); }
+
+void Trie::buildTopTable(std::size_t depth, std::size_t minWords, std::size_t limit)
+{
+	clearTopTable();
+	if (limit == 0) return;
+
+	std::vector<std::pair<std::uint32_t, std::string>> hot;
+	std::string currentWord;
+	selectHotNodes(m_nil, currentWord, depth, minWords, hot);
+	std::sort(hot.begin(), hot.end());
+
+	// a popular word is a top completion of most of its prefixes, so each is stored once
+	std::unordered_map<std::string, TopWord> stored;
+	std::vector<std::string> best;
+
+	for (const auto &[node, prefix] : hot)
+	{
+		best.clear();
+		collectBest(node, prefix, best, limit, true);
+
+		m_topEntries.push_back(TopEntry{node, static_cast<std::uint32_t>(m_topWords.size())});
+		for (const auto &word : best)
+		{
+			auto [it, added] {stored.try_emplace(word)};
+			if (added)
+			{
+				it->second = TopWord{static_cast<std::uint32_t>(m_topText.size()), static_cast<std::uint32_t>(word.size())};
+				m_topText += word;
+			}
+			m_topWords.push_back(it->second);
+		}
+	}
+
+	m_topEntryCount = static_cast<std::uint32_t>(m_topEntries.size());
+	m_topEntries.push_back(TopEntry{UINT32_MAX, static_cast<std::uint32_t>(m_topWords.size())}); // sentinel closes the last range
+	m_topTextSize = static_cast<std::uint32_t>(m_topText.size());
+	m_topLimit = static_cast<std::uint32_t>(limit);
+	m_topDepth = static_cast<std::uint32_t>(depth);
+	m_topMinWords = static_cast<std::uint32_t>(std::min<std::size_t>(minWords, UINT32_MAX));
+	syncView();
+}
+
+bool Trie::hasTopTable() const { return m_topEntryCount != 0; }
+
+bool Trie::setScore(std::string_view word, std::uint32_t score)
+{
+	detach();
+
+	std::vector<std::uint32_t> path {m_nil};
+	for (char c : word)
+	{
+		int index {c - 'a'};
+		if (index < 0 || index >= dct::g_alpha) return false;
 
+		std::uint32_t next {child(path.back(), index)};
+		if (next == m_nil) return false; // not found
+		path.push_back(next);
+	}
+	if (!m_nodes[path.back()].m_isEndOfWord) return false;
+
+	m_nodes[path.back()].m_score = score;
+
+	// fix the subtree maxima from the word back up to the root
+	for (auto it {path.rbegin()}; it != path.rend(); ++it) refreshMaxScore(*it);
+	refreshTopRows(word);
 	return true;
 }
 
+std::uint32_t Trie::getScore(std::string_view word) const
+{
+	std::uint32_t node {m_nil};
+	for (char c : word)
+	{
+		int index {c - 'a'};
+		if (index < 0 || index >= dct::g_alpha) return 0;
+
+		node = child(node, index);
+		if (node == m_nil) return 0; // not found
+	}
+
+	return nodeAt(node).m_isEndOfWord ? nodeAt(node).m_score : 0;
+}
+
 /*********************************
 // Trie Helper Functions
 *********************************/
-void Trie::deleteTrie(TrieNode *node)
+void Trie::syncView()
 {
-	if (!node) return;
-	
-	// DFS
-	for (int i{0}; i < dct::g_alpha; ++i)
+	if (isMapped())
 	{
-		deleteTrie(node->m_children[i]);
+		m_nodeView = reinterpret_cast<const TrieNode *>(m_image.data() + sizeof(ImageHeader));
+		m_edgeView = reinterpret_cast<const std::uint32_t *>(m_nodeView + m_imageNodes);
+		if (hasTopTable())
+		{
+			m_topEntryView = reinterpret_cast<const TopEntry *>(m_edgeView + m_imageEdges);
+			m_topWordView = reinterpret_cast<const TopWord *>(m_topEntryView + m_topEntryCount + 1);
+			m_topTextView = reinterpret_cast<const char *>(m_topWordView + m_topEntryView[m_topEntryCount].m_first);
+		}
+		return;
 	}
-	
-	delete node;
+
+	m_nodeView = m_nodes.data();
+	m_edgeView = m_edges.data();
+	m_topEntryView = m_topEntries.data();
+	m_topWordView = m_topWords.data();
+	m_topTextView = m_topText.data();
+}
+
+void Trie::detach()
+{
+	if (!isMapped()) return;
+
+	m_nodes.assign(m_nodeView, m_nodeView + m_imageNodes);
+	m_edges.assign(m_edgeView, m_edgeView + m_imageEdges);
+	if (hasTopTable()) // writes keep the table up to date from here on, so it moves into the arena too
+	{
+		m_topEntries.assign(m_topEntryView, m_topEntryView + m_topEntryCount + 1);
+		m_topWords.assign(m_topWordView, m_topWordView + m_topEntryView[m_topEntryCount].m_first);
+		m_topText.assign(m_topTextView, m_topTextSize);
+	}
+	m_freeNodes = m_nil;
+	m_freeEdges.fill(0);
+
+	m_image.close();
+	syncView();
+}
+
+std::uint32_t Trie::child(std::uint32_t node, int index) const
+{
+	const TrieNode &n {nodeAt(node)};
+	return n.hasChild(index) ? m_edgeView[n.m_children + n.slot(index)] : m_nil;
+}
+
+void Trie::refreshMaxScore(std::uint32_t node)
+{
+	TrieNode &n {m_nodes[node]};
+	std::uint32_t best {n.m_isEndOfWord ? n.m_score : 0};
+
+	for (int slot{0}; slot < n.childCount(); ++slot)
+	{
+		best = std::max(best, m_nodes[m_edges[n.m_children + slot]].m_maxScore);
+	}
+	n.m_maxScore = best;
+}
+
+std::uint32_t Trie::addChild(std::uint32_t node, int index)
+{
+	std::uint32_t newChild {allocNode()}; // may grow m_nodes, so no references are held above this
+
+	// move the packed block into one slot larger and shift later letters right
+	int count {m_nodes[node].childCount()};
+	int pos {m_nodes[node].slot(index)};
+	std::uint32_t oldBlock {m_nodes[node].m_children};
+	std::uint32_t newBlock {allocEdges(count + 1)};
+
+	for (int i{0}; i < pos; ++i) m_edges[newBlock + i] = m_edges[oldBlock + i];
+	m_edges[newBlock + pos] = newChild;
+	for (int i{pos}; i < count; ++i) m_edges[newBlock + i + 1] = m_edges[oldBlock + i];
+
+	if (count) freeEdges(oldBlock, count);
+
+	TrieNode &n {m_nodes[node]};
+	n.m_children = newBlock;
+	n.m_childMask |= (1u << index);
+	return newChild;
+}
+
+void Trie::eraseChild(std::uint32_t node, int index)
+{
+	// only removes the slot, the child itself is freed by the caller
+	int count {m_nodes[node].childCount()};
+	int pos {m_nodes[node].slot(index)};
+	std::uint32_t oldBlock {m_nodes[node].m_children};
+	std::uint32_t newBlock {0};
+
+	if (count > 1)
+	{
+		newBlock = allocEdges(count - 1);
+		for (int i{0}; i < pos; ++i) m_edges[newBlock + i] = m_edges[oldBlock + i];
+		for (int i{pos + 1}; i < count; ++i) m_edges[newBlock + i - 1] = m_edges[oldBlock + i];
+	}
+	freeEdges(oldBlock, count);
+
+	TrieNode &n {m_nodes[node]};
+	n.m_children = newBlock;
+	n.m_childMask &= ~(1u << index);
+}
+
+std::uint32_t Trie::allocNode()
+{
+	// reuse a removed node before bumping the arena
+	if (m_freeNodes != m_nil)
+	{
+		std::uint32_t node {m_freeNodes};
+		m_freeNodes = m_nodes[node].m_children;
+		m_nodes[node] = TrieNode();
+		return node;
+	}
+
+	m_nodes.emplace_back();
+	syncView();
+	return static_cast<std::uint32_t>(m_nodes.size() - 1);
+}
+
+void Trie::freeNode(std::uint32_t node)
+{
+	m_nodes[node] = TrieNode();
+	m_nodes[node].m_children = m_freeNodes;
+	m_freeNodes = node;
+}
+
+std::uint32_t Trie::allocEdges(int size)
+{
+	// blocks are exact-sized, so a freed block can be handed to any node with the same child count
+	std::uint32_t block {m_freeEdges[size]};
+	if (block)
+	{
+		m_freeEdges[size] = m_edges[block];
+		return block;
+	}
+
+	block = static_cast<std::uint32_t>(m_edges.size());
+	m_edges.resize(m_edges.size() + size);
+	syncView();
+	return block;
+}
+
+void Trie::freeEdges(std::uint32_t block, int size)
+{
+	m_edges[block] = m_freeEdges[size];
+	m_freeEdges[size] = block;
+}
+
+void Trie::freeSubtree(std::uint32_t node)
+{
+	const TrieNode &n {m_nodes[node]};
+	int count {n.childCount()};
+	std::uint32_t block {n.m_children};
+
+	for (int i{0}; i < count; ++i) freeSubtree(m_edges[block + i]);
+	if (count) freeEdges(block, count);
+	freeNode(node);
 }
 
-void Trie::rewrite(const TrieNode *node, std::string &currentWord, std::ostream &out) const
+void Trie::dropShard(int index)
+{
+	std::uint32_t old {child(m_nil, index)};
+	if (old == m_nil) return;
+
+	freeSubtree(old);
+	eraseChild(m_nil, index);
+}
+
+void Trie::adoptShard(int index, Trie &shard)
+{
+	// only a plain arena holding just this letter can be taken over as is
+	if (shard.isMapped() || (shard.nodeAt(m_nil).m_childMask & ~(1u << index)) || shard.nodeAt(m_nil).m_isEndOfWord)
+	{
+		setShard(static_cast<char>('a' + index), shard);
+		shard.clear();
+		return;
+	}
+
+	dropShard(index);
+	std::uint32_t source {shard.child(m_nil, index)};
+	if (source == m_nil)
+	{
+		shard.clear();
+		return;
+	}
+	std::uint32_t target {addChild(m_nil, index)};
+
+	// append both arrays, moving every node index by nodeOffset and every block index by edgeOffset
+	std::uint32_t nodeOffset {static_cast<std::uint32_t>(m_nodes.size())};
+	std::uint32_t edgeOffset {static_cast<std::uint32_t>(m_edges.size())};
+	m_nodes.insert(m_nodes.end(), shard.m_nodes.begin(), shard.m_nodes.end());
+	m_edges.insert(m_edges.end(), shard.m_edges.begin(), shard.m_edges.end());
+	for (std::size_t i{nodeOffset}; i < m_nodes.size(); ++i) m_nodes[i].m_children += edgeOffset;
+	for (std::size_t i{edgeOffset}; i < m_edges.size(); ++i) m_edges[i] += nodeOffset;
+	syncView();
+
+	// the letter's node takes the slot addChild made; its old slot, the shard's root and the shard's
+	// free lists (whose links the loop above moved wrongly) go on this trie's free lists
+	m_nodes[target] = m_nodes[nodeOffset + source];
+	freeNode(nodeOffset + source);
+	freeNode(nodeOffset + m_nil);
+	for (std::uint32_t node {shard.m_freeNodes}; node != m_nil; node = shard.m_nodes[node].m_children) freeNode(nodeOffset + node);
+	for (int size{1}; size <= dct::g_alpha; ++size)
+	{
+		for (std::uint32_t block {shard.m_freeEdges[size]}; block; block = shard.m_edges[block]) freeEdges(edgeOffset + block, size);
+	}
+
+	refreshMaxScore(m_nil);
+	shard.clear();
+}
+
+void Trie::copySubtree(std::uint32_t node, const Trie &from, std::uint32_t source)
+{
+	const TrieNode &s {from.nodeAt(source)};
+	int count {s.childCount()};
+	std::uint32_t block {count ? allocEdges(count) : 0};
+
+	TrieNode &n {m_nodes[node]};
+	n = s;
+	n.m_children = block;
+
+	// allocating may grow the arena, so the children are wired by index
+	for (int i{0}; i < count; ++i)
+	{
+		std::uint32_t next {allocNode()};
+		m_edges[block + i] = next;
+		copySubtree(next, from, from.m_edgeView[s.m_children + i]);
+	}
+}
+
+void Trie::rewrite(std::uint32_t node, std::string &currentWord, std::ostream &out) const
 { // similar to collectFromNode 
-	if (!node) return;
-	if (node->m_isEndOfWord) out << currentWord << '\n'; // write complete word
+	if (nodeAt(node).m_isEndOfWord) out << currentWord << '\n'; // write complete word
 	
 	// DFS
 	for (int i{0}; i < dct::g_alpha; ++i)
 	{
-		if (node->m_children[i])
+		std::uint32_t next {child(node, i)};
+		if (next != m_nil)
 		{
 			char letter {static_cast<char>('a' + i)};
 			currentWord.push_back(letter); // build word 
-			rewrite(node->m_children[i], currentWord, out);
+			rewrite(next, currentWord, out);
 			currentWord.pop_back(); // backtrack (undo complete word) works because of recursive rewrite
 		}
 	}
 }
 
-void Trie::dumpNode(const TrieNode *node, const std::string &prefix) const
+void Trie::dumpNode(std::uint32_t node, const std::string &prefix) const
 { 
-	if (!node) return; 
-	
 	// DFS
 	for (int i{0}; i < dct::g_alpha; ++i)
 	{
 		char letter {static_cast<char>('a' + i)};
-		const TrieNode *child = node->m_children[i];
-		if (!child) continue;
-		bool isLast = true;
-		
-		// check for another sibling
-		for (int j{i+1}; j < dct::g_alpha; ++j)
-		{
-			// check for later children
-			if (node->m_children[j])
-			{
-				// current child is not the last sibling
-				isLast = false;
-				break; 
-			}
-		}
+		std::uint32_t next {child(node, i)};
+		if (next == m_nil) continue;
+
+		// current child is the last sibling if no later letters are set
+		bool isLast = (nodeAt(node).m_childMask >> (i + 1)) == 0;
 
 		// print graphics
 		std::cout << prefix << (isLast ? "└── " : "├── ") << letter;
-		if (child->m_isEndOfWord) std::cout << " *"; 
+		if (nodeAt(next).m_isEndOfWord) std::cout << (nodeAt(next).m_isForm ? " ~" : " *");
 		std::cout << '\n';
 
-		dumpNode(node->m_children[i], prefix + (isLast ? "    " : "│   "));	
+		dumpNode(next, prefix + (isLast ? "    " : "│   "));	
 	}
 }
 
-bool Trie::remove(TrieNode *&node, std::string_view word)
+bool Trie::remove(std::uint32_t node, std::string_view word)
 {
-	if (!node) return false;
-
 	// check if end of word	
 	if (word.empty())
 	{
-		if (!node->m_isEndOfWord) return false; // word is not stored
+		if (!m_nodes[node].m_isEndOfWord) return false; // word is not stored
 	
-		node->m_isEndOfWord = false;
-
-		// check if the node has children
-		for (int i{0}; i < dct::g_alpha; ++i)
-		{
-			// if the node has children it's still needed for another word
-			if (node->m_children[i]) return true;
-		}
-
-		// if it has no children we can safely remove the node
-		delete node;
-		node = nullptr;
+		m_nodes[node].m_isEndOfWord = false;
+		m_nodes[node].m_isForm = false;
+		m_nodes[node].m_wordID = -1;
+		m_nodes[node].m_score = 0;
+		refreshMaxScore(node);
 		return true;
 	}
 	
 	// find child index
 	int index {word[0] - 'a'};
-	if (remove(node->m_children[index], word.substr(1))) // recursively remove the rest of the word
-	{
-		if (node->m_isEndOfWord) return true; // if the current node marks the end of another word, preserve it
+	if (index < 0 || index >= dct::g_alpha) return false;
 
-		// check if node has any children and is still needed
-		for (int i{0}; i < dct::g_alpha; ++i)
-		{
-			if (node->m_children[i]) return true;
-		}
-		
-		// if the node is not the end of a word and has no children
-		delete node;
-		node = nullptr;
-		return true;
+	std::uint32_t next {child(node, index)};
+	if (next == m_nil) return false;
+
+	if (!remove(next, word.substr(1))) return false; // recursively remove the rest of the word
+
+	// if the child is not the end of a word and has no children it is no longer needed
+	const TrieNode &c {m_nodes[next]};
+	if (!c.m_isEndOfWord && !c.hasChildren())
+	{
+		eraseChild(node, index);
+		freeNode(next);
 	}
-	
-	return false;
+	refreshMaxScore(node); // the removed word may have been the best below here
+
+	return true;
 }
 
-void Trie::collectFromNode(const TrieNode *node, std::string &currentWord, std::vector<std::string> &out, std::size_t limit) const
+void Trie::collectFromNode(std::uint32_t node, std::string &currentWord, std::vector<std::string> &out, std::size_t limit) const
 { // similar to rewrite
-	if (!node || out.size() >= limit) return;
-	if (node->m_isEndOfWord) out.push_back(currentWord); // add complete word to results vector
+	if (out.size() >= limit) return;
+	if (nodeAt(node).m_isEndOfWord) out.push_back(currentWord); // add complete word to results vector
 
 	for (int i{0}; i < dct::g_alpha && out.size() < limit; ++i)
 	{
-		if (node->m_children[i])
+		std::uint32_t next {child(node, i)};
+		if (next != m_nil)
 		{
 			char letter {static_cast<char>('a' + i)};
 			currentWord.push_back(letter); // build word
-			collectFromNode(node->m_children[i], currentWord, out, limit);
+			collectFromNode(next, currentWord, out, limit);
 			currentWord.pop_back(); // backtrack (undo complete word) works because of recursive collectFromNode 
 		}
 	}	
 }
+
+void Trie::collectEntries(std::uint32_t node, std::string &currentWord, std::vector<WordEntry> &out) const
+{ // collectFromNode, keeping the id and score
+	const TrieNode &n {nodeAt(node)};
+	if (n.m_isEndOfWord) out.push_back(WordEntry{currentWord, n.m_wordID, n.m_score, n.m_isForm});
+
+	for (int i{0}; i < dct::g_alpha; ++i)
+	{
+		std::uint32_t next {child(node, i)};
+		if (next == m_nil) continue;
+
+		currentWord.push_back(static_cast<char>('a' + i));
+		collectEntries(next, currentWord, out);
+		currentWord.pop_back();
+	}
+}
+
+void Trie::collectBest(std::uint32_t node, std::string_view prefix, std::vector<std::string> &out, std::size_t limit, bool withPrefix) const
+{
+	std::uint32_t start {node};
+	// best first: a subtree is ranked by the best word in it, so the queue only opens
+	// the nodes on the way to the next best word (about limit * word length of them).
+	// An entry is its last letter and the entry it came from, so the text of a word is
+	// only put together once the word comes out
+	struct Entry
+	{
+		std::uint32_t m_node;
+		std::uint32_t m_parent; // entry one letter up (the start has none)
+		std::uint32_t m_depth; // letters below start
+		char m_letter;
+		bool m_isWord; // a finished word, not a subtree still to open
+	};
+	std::vector<Entry> entries;
+	std::vector<std::pair<std::uint32_t, std::uint32_t>> queue; // (word score or best score below the node, entry)
+
+	// alphabetical order of two entries' words: line them up at the same depth, then climb both
+	// until they reach the same node (same node, same text); the topmost letters that differ decide
+	auto compare = [&entries](std::uint32_t a, std::uint32_t b)
+	{
+		int order {0};
+		for (; entries[a].m_depth > entries[b].m_depth; a = entries[a].m_parent) order = 1; // b is a's prefix, unless a letter differs
+		for (; entries[b].m_depth > entries[a].m_depth; b = entries[b].m_parent) order = -1;
+		for (; entries[a].m_node != entries[b].m_node; a = entries[a].m_parent, b = entries[b].m_parent)
+		{
+			order = entries[a].m_letter < entries[b].m_letter ? -1 : 1;
+		}
+		return order;
+	};
+	auto later = [&entries, &compare](const auto &a, const auto &b)
+	{
+		// higher score first, then alphabetical, and a word before its own subtree
+		if (a.first != b.first) return a.first < b.first;
+		if (int order {compare(a.second, b.second)}) return order > 0;
+		return !entries[a.second].m_isWord && entries[b.second].m_isWord;
+	};
+	auto push = [&](std::uint32_t score, Entry entry)
+	{
+		queue.emplace_back(score, static_cast<std::uint32_t>(entries.size()));
+		entries.push_back(entry);
+		std::push_heap(queue.begin(), queue.end(), later);
+	};
+	push(nodeAt(node).m_maxScore, Entry{node, UINT32_MAX, 0, '\0', false});
+
+	while (!queue.empty() && out.size() < limit)
+	{
+		std::pop_heap(queue.begin(), queue.end(), later);
+		std::uint32_t index {queue.back().second};
+		Entry top {entries[index]}; // pushes below may reallocate entries
+		queue.pop_back();
+
+		if (top.m_isWord)
+		{
+			std::string word {prefix};
+			word.resize(prefix.size() + top.m_depth);
+			for (std::uint32_t e {index}; entries[e].m_depth > 0; e = entries[e].m_parent) word[prefix.size() + entries[e].m_depth - 1] = entries[e].m_letter;
+			out.push_back(std::move(word));
+			continue;
+		}
+
+		const TrieNode &n {nodeAt(top.m_node)};
+		if (n.m_isEndOfWord && (withPrefix || top.m_node != start))
+		{
+			top.m_isWord = true; // the same text as the subtree it ends
+			push(n.m_score, top);
+		}
+
+		int slot {0};
+		for (std::uint32_t mask {n.m_childMask}; mask; mask &= mask - 1, ++slot)
+		{
+			std::uint32_t next {m_edgeView[n.m_children + slot]};
+			push(nodeAt(next).m_maxScore, Entry{next, index, top.m_depth + 1, static_cast<char>('a' + __builtin_ctz(mask)), false});
+		}
+	}
+}
+
+void Trie::bestWord(std::uint32_t node, std::string &currentWord) const
+{
+	// the top-1 search needs no queue: follow the child holding the subtree's best score
+	// (first letter on ties) until the node's own word carries it, which matches collectBest's order
+	while (true)
+	{
+		const TrieNode &n {nodeAt(node)};
+		if (n.m_isEndOfWord && n.m_score == n.m_maxScore) return;
+
+		std::uint32_t from {node};
+		int slot {0};
+		for (std::uint32_t mask {n.m_childMask}; mask; mask &= mask - 1, ++slot)
+		{
+			std::uint32_t next {m_edgeView[n.m_children + slot]};
+			if (nodeAt(next).m_maxScore == n.m_maxScore)
+			{
+				currentWord.push_back(static_cast<char>('a' + __builtin_ctz(mask)));
+				node = next;
+				break;
+			}
+		}
+		if (node == from) return; // only an empty root has nowhere to go
+	}
+}
+
+bool Trie::collectFromTable(std::uint32_t node, std::size_t depth, std::vector<std::string> &out, std::size_t limit, bool withPrefix) const
+{
+	// skipping the prefix's own word can cost one extra row entry
+	if (m_topEntryCount == 0 || limit + (withPrefix ? 0 : 1) > m_topLimit) return false;
+
+	const TopEntry *end {m_topEntryView + m_topEntryCount};
+	const TopEntry *entry {std::lower_bound(m_topEntryView, end, node, [](const TopEntry &e, std::uint32_t n) { return e.m_node < n; })};
+	if (entry == end || entry->m_node != node) return false;
+
+	// a table row is the search result for m_topLimit, so its first limit words are the answer for limit
+	std::size_t found {0};
+	for (std::uint32_t i{entry->m_first}; i < entry[1].m_first && found < limit; ++i)
+	{
+		if (!withPrefix && m_topWordView[i].m_length == depth) continue; // the only completion as long as the prefix is the prefix
+		out.emplace_back(m_topTextView + m_topWordView[i].m_offset, m_topWordView[i].m_length);
+		++found;
+	}
+	return true;
+}
+
+void Trie::clearTopTable()
+{
+	std::vector<TopEntry>().swap(m_topEntries);
+	std::vector<TopWord>().swap(m_topWords);
+	std::string().swap(m_topText);
+	m_topEntryCount = 0;
+	m_topTextSize = 0;
+	m_topLimit = 0;
+	m_topDepth = 0;
+	m_topMinWords = 0;
+	m_topDead = 0;
+	m_topEntryView = nullptr;
+	m_topWordView = nullptr;
+	m_topTextView = nullptr;
+}
+
+void Trie::refreshTopRows(std::string_view word, const std::vector<std::uint32_t> &before)
+{
+	if (!hasTopTable()) return;
+
+	// a change to word only moves the best words and word counts of its own prefixes, so only
+	// their rows can be stale (or missing, or no longer wanted); the rest of the table stands
+	std::vector<std::uint32_t> after;
+	std::vector<std::string> best;
+	std::string prefix;
+	std::uint32_t node {m_nil};
+	for (char c : word)
+	{
+		node = child(node, c - 'a');
+		if (node == m_nil) break;
+		prefix.push_back(c);
+		after.push_back(node);
+
+		best.clear();
+		if (prefix.size() <= m_topDepth || countWords(node, m_topMinWords) >= m_topMinWords) collectBest(node, prefix, best, m_topLimit, true);
+		setTopRow(node, best);
+	}
+
+	// nodes a removal freed
+	for (std::uint32_t old : before)
+	{
+		if (std::find(after.begin(), after.end(), old) == after.end()) setTopRow(old, {});
+	}
+}
+
+void Trie::setTopRow(std::uint32_t node, const std::vector<std::string> &words)
+{
+	auto end {m_topEntries.begin() + m_topEntryCount};
+	auto entry {std::lower_bound(m_topEntries.begin(), end, node, [](const TopEntry &e, std::uint32_t n) { return e.m_node < n; })};
+	bool exists {entry != end && entry->m_node == node};
+	if (!exists && words.empty()) return;
+
+	// words the row had keep their text, new ones go on the end; what the dropped ones leave behind is packed away later
+	std::uint32_t first {entry->m_first}, oldCount {exists ? entry[1].m_first - first : 0};
+	std::vector<TopWord> row;
+	for (auto old {m_topWords.begin() + first}; old != m_topWords.begin() + first + oldCount; ++old) m_topDead += old->m_length;
+	for (const auto &word : words)
+	{
+		auto kept {std::find_if(m_topWords.begin() + first, m_topWords.begin() + first + oldCount, [&](const TopWord &w)
+			{ return std::string_view{m_topText.data() + w.m_offset, w.m_length} == word; })};
+		if (kept != m_topWords.begin() + first + oldCount)
+		{
+			row.push_back(*kept);
+			m_topDead -= kept->m_length;
+		}
+		else
+		{
+			row.push_back(TopWord{static_cast<std::uint32_t>(m_topText.size()), static_cast<std::uint32_t>(word.size())});
+			m_topText += word;
+		}
+	}
+
+	m_topWords.erase(m_topWords.begin() + first, m_topWords.begin() + first + oldCount);
+	m_topWords.insert(m_topWords.begin() + first, row.begin(), row.end());
+	if (!exists)
+	{
+		entry = m_topEntries.insert(entry, TopEntry{node, first});
+		++m_topEntryCount;
+	}
+	for (auto next {entry + 1}; next != m_topEntries.end(); ++next) next->m_first = next->m_first - oldCount + static_cast<std::uint32_t>(row.size());
+	if (words.empty())
+	{
+		m_topEntries.erase(entry);
+		--m_topEntryCount;
+	}
+
+	if (2 * m_topDead > m_topText.size()) packTopText(); // so a long run of writes can't grow it without bound
+	m_topTextSize = static_cast<std::uint32_t>(m_topText.size());
+	syncView();
+}
+
+void Trie::refreshShardRows(int index)
+{
+	// only prefixes under the letter changed, and the root (their one other ancestor) has no row:
+	// the old letter's rows go, the new letter's hot prefixes get theirs, every other row is kept.
+	// A row's words all start with its prefix, so its first word tells which letter it is under
+	// (its node may already be freed, or reused by the new letter)
+	char letter {static_cast<char>('a' + index)};
+	std::vector<std::pair<std::uint32_t, std::string>> hot;
+	std::uint32_t node {child(m_nil, index)};
+	std::string prefix(1, letter);
+	if (node != m_nil) selectHotNodes(node, prefix, m_topDepth, m_topMinWords, hot);
+	std::sort(hot.begin(), hot.end());
+
+	std::vector<TopEntry> entries;
+	std::vector<TopWord> words;
+	std::unordered_map<std::string, TopWord> stored; // a word the new rows share is stored once
+	std::vector<std::string> best;
+	auto add = [&](const std::pair<std::uint32_t, std::string> &row)
+	{
+		best.clear();
+		collectBest(row.first, row.second, best, m_topLimit, true);
+		entries.push_back(TopEntry{row.first, static_cast<std::uint32_t>(words.size())});
+		for (const auto &word : best)
+		{
+			auto [it, added] {stored.try_emplace(word)};
+			if (added)
+			{
+				it->second = TopWord{static_cast<std::uint32_t>(m_topText.size()), static_cast<std::uint32_t>(word.size())};
+				m_topText += word;
+			}
+			words.push_back(it->second);
+		}
+	};
+
+	// both lists are sorted by node, so the new rows merge in as the old ones are copied over
+	auto next {hot.begin()};
+	for (std::uint32_t e{0}; e < m_topEntryCount; ++e)
+	{
+		const TopEntry &entry {m_topEntries[e]};
+		for (; next != hot.end() && next->first < entry.m_node; ++next) add(*next);
+
+		auto first {m_topWords.begin() + entry.m_first}, last {m_topWords.begin() + m_topEntries[e + 1].m_first};
+		if (first == last || m_topText[first->m_offset] == letter)
+		{
+			for (auto word {first}; word != last; ++word) m_topDead += word->m_length;
+			continue;
+		}
+		entries.push_back(TopEntry{entry.m_node, static_cast<std::uint32_t>(words.size())});
+		words.insert(words.end(), first, last);
+	}
+	for (; next != hot.end(); ++next) add(*next);
+
+	m_topEntryCount = static_cast<std::uint32_t>(entries.size());
+	entries.push_back(TopEntry{UINT32_MAX, static_cast<std::uint32_t>(words.size())});
+	m_topEntries.swap(entries);
+	m_topWords.swap(words);
+	if (2 * m_topDead > m_topText.size()) packTopText();
+	m_topTextSize = static_cast<std::uint32_t>(m_topText.size());
+	syncView();
+}
+
+void Trie::packTopText()
+{
+	// only the text some row still points at, a word shared between rows still stored once
+	std::string text;
+	std::unordered_map<std::uint32_t, std::uint32_t> moved; // old offset -> new
+	for (TopWord &word : m_topWords)
+	{
+		auto [it, added] {moved.try_emplace(word.m_offset, static_cast<std::uint32_t>(text.size()))};
+		if (added) text.append(m_topText, word.m_offset, word.m_length);
+		word.m_offset = it->second;
+	}
+	m_topText.swap(text);
+	m_topDead = 0;
+}
+
+std::size_t Trie::countWords(std::uint32_t node, std::size_t limit) const
+{
+	const TrieNode &n {nodeAt(node)};
+	std::size_t words {n.m_isEndOfWord ? 1u : 0u};
+
+	int slot {0};
+	for (std::uint32_t mask {n.m_childMask}; mask && words < limit; mask &= mask - 1, ++slot)
+	{
+		words += countWords(m_edgeView[n.m_children + slot], limit - words);
+	}
+	return words;
+}
+
+std::size_t Trie::selectHotNodes(std::uint32_t node, std::string &currentWord, std::size_t depth, std::size_t minWords,
+	std::vector<std::pair<std::uint32_t, std::string>> &hot) const
+{
+	// post-order, so the words below a node are counted before deciding whether it is hot
+	const TrieNode &n {nodeAt(node)};
+	std::size_t words {n.m_isEndOfWord ? 1u : 0u};
+
+	int slot {0};
+	for (std::uint32_t mask {n.m_childMask}; mask; mask &= mask - 1, ++slot)
+	{
+		currentWord.push_back(static_cast<char>('a' + __builtin_ctz(mask)));
+		words += selectHotNodes(m_edgeView[n.m_children + slot], currentWord, depth, minWords, hot);
+		currentWord.pop_back();
+	}
+
+	// the root isn't a prefix anyone asks for
+	if (node != m_nil && (currentWord.size() <= depth || words >= minWords)) hot.emplace_back(node, currentWord);
+	return words;
+}
+
+void Trie::walkDistance(std::uint32_t node, std::string_view word, int maxDistance, std::vector<int> &rows, 
+	std::string &currentWord, std::vector<std::pair<std::string, int>> &out) const
+{
+	std::size_t columns {word.size() + 1};
+	std::size_t depth {currentWord.size() + 1}; // row filled for each child
+	const TrieNode &n {nodeAt(node)};
+
+	// visit only the letters that exist (set bits of the mask, in order)
+	int slot {0};
+	for (std::uint32_t mask {n.m_childMask}; mask; mask &= mask - 1, ++slot)
+	{
+		int i {__builtin_ctz(mask)};
+		std::uint32_t next {m_edgeView[n.m_children + slot]};
+
+		char letter {static_cast<char>('a' + i)};
+		const int *above {&rows[(depth - 1) * columns]};
+		const int *twoAbove {depth >= 2 ? &rows[(depth - 2) * columns] : nullptr};
+		int *row {&rows[depth * columns]};
+
+		row[0] = static_cast<int>(depth);
+		int rowMin {row[0]};
+
+		for (std::size_t j{1}; j < columns; ++j)
+		{
+			int cost {word[j - 1] == letter ? 0 : 1};
+			int best {std::min({above[j] + 1, row[j - 1] + 1, above[j - 1] + cost})}; // delete, insert, substitute
+
+			// adjacent transposition ("teh" -> "the")
+			if (twoAbove && j >= 2 && word[j - 2] == letter && word[j - 1] == currentWord.back())
+				best = std::min(best, twoAbove[j - 2] + 1);
+
+			row[j] = best;
+			rowMin = std::min(rowMin, best);
+		}
+
+		// no cell within the limit means no word below this node can be either
+		if (rowMin > maxDistance) continue;
+
+		currentWord.push_back(letter);
+		if (nodeAt(next).m_isEndOfWord && row[columns - 1] <= maxDistance) out.emplace_back(currentWord, row[columns - 1]);
+		walkDistance(next, word, maxDistance, rows, currentWord, out);
+		currentWord.pop_back();
+	}
+}
+
+void Trie::countNodes(std::uint32_t node, std::size_t &nodes, std::size_t &edges, std::size_t &words) const
+{
+	const TrieNode &n {nodeAt(node)};
+	++nodes;
+	edges += n.childCount();
+	if (n.m_isEndOfWord) ++words;
+
+	// DFS
+	for (int i{0}; i < n.childCount(); ++i)
+	{
+		countNodes(m_edgeView[n.m_children + i], nodes, edges, words);
+	}
+}
@@ -0,0 +1,205 @@
+#include "WordCache.h"
+#include <algorithm>
+
+namespace
+{
+	// strings past the small-string buffer own a heap block
+	std::size_t textBytes(const std::string &text) { return text.capacity() > 15 ? text.capacity() + 1 : 0; }
+
+	std::size_t textBytes(const std::vector<std::string> &texts)
+	{
+		std::size_t bytes {texts.capacity() * sizeof(std::string)};
+		for (const auto &text : texts) bytes += textBytes(text);
+		return bytes;
+	}
+
+	// list node plus hash map node for each entry, roughly
+	constexpr std::size_t g_entryOverhead {96};
+}
+
+WordCache::WordCache(std::size_t capacityBytes, bool admission) : m_capacity{capacityBytes}, m_admission{admission}
+{
+	// about four counters per entry that fits, taking 1 KB as a typical entry
+	m_width = 256;
+	while (m_width < capacityBytes / 256) m_width <<= 1;
+	m_sketch.assign(m_rows * m_width, 0);
+	m_stats.m_capacity = capacityBytes;
+}
+
+std::shared_ptr<const WordInfo> WordCache::find(int word_id)
+{
+	std::lock_guard<std::mutex> lock {m_mutex};
+	record(word_id);
+
+	auto it {m_index.find(word_id)};
+	if (it == m_index.end())
+	{
+		++m_stats.m_misses;
+		return nullptr;
+	}
+
+	m_lru.splice(m_lru.begin(), m_lru, it->second); // most recent first
+	++m_stats.m_hits;
+	return it->second->m_info;
+}
+
+std::shared_ptr<const WordInfo> WordCache::insert(int word_id, WordInfo &&info)
+{
+	std::shared_ptr<const WordInfo> shared {std::make_shared<const WordInfo>(std::move(info))};
+	std::size_t size {bytes(*shared) + g_entryOverhead};
+
+	std::lock_guard<std::mutex> lock {m_mutex};
+	if (size > m_capacity)
+	{
+		++m_stats.m_rejected;
+		return shared;
+	}
+
+	// an entry already cached for word_id is replaced in place, but only once the new one is admitted
+	auto it {m_index.find(word_id)};
+	std::size_t replaced {it == m_index.end() ? 0 : it->second->m_bytes};
+
+	// the entries that would have to go, least recent first: each has to be wanted less than this one
+	if (m_admission && m_bytes - replaced + size > m_capacity)
+	{
+		std::uint8_t wanted {frequency(word_id)};
+		std::size_t freed {replaced};
+		for (auto victim {m_lru.rbegin()}; victim != m_lru.rend() && m_bytes - freed + size > m_capacity; ++victim)
+		{
+			if (victim->m_wordID == word_id) continue; // already counted
+			if (frequency(victim->m_wordID) >= wanted)
+			{
+				++m_stats.m_rejected;
+				return shared;
+			}
+			freed += victim->m_bytes;
+		}
+	}
+
+	if (it != m_index.end())
+	{
+		m_lru.splice(m_lru.begin(), m_lru, it->second); // most recent first, and out of evictLast's way
+		m_bytes = m_bytes - replaced + size;
+		it->second->m_info = shared;
+		it->second->m_bytes = size;
+		while (m_bytes > m_capacity) evictLast();
+		return shared;
+	}
+
+	while (m_bytes + size > m_capacity) evictLast();
+	m_lru.push_front(Entry{word_id, shared, size});
+	m_index[word_id] = m_lru.begin();
+	m_bytes += size;
+	return shared;
+}
+
+void WordCache::erase(int word_id)
+{
+	std::lock_guard<std::mutex> lock {m_mutex};
+
+	auto it {m_index.find(word_id)};
+	if (it == m_index.end()) return;
+
+	m_bytes -= it->second->m_bytes;
+	m_lru.erase(it->second);
+	m_index.erase(it);
+}
+
+void WordCache::clear()
+{
+	std::lock_guard<std::mutex> lock {m_mutex};
+
+	m_lru.clear();
+	m_index.clear();
+	m_bytes = 0;
+	std::fill(m_sketch.begin(), m_sketch.end(), 0);
+	m_additions = 0;
+}
+
+WordCache::Stats WordCache::stats() const
+{
+	std::lock_guard<std::mutex> lock {m_mutex};
+
+	Stats stats {m_stats};
+	stats.m_entries = m_lru.size();
+	stats.m_bytes = m_bytes;
+	return stats;
+}
+
+void WordCache::memoryReport(std::ostream &out) const
+{
+	Stats s {stats()};
+	std::size_t lookups {s.m_hits + s.m_misses};
+
+	out << "cache: " << s.m_entries << " entries, " << s.m_bytes << " of " << s.m_capacity << " bytes\n"
+		<< "hits: " << s.m_hits << ", misses: " << s.m_misses;
+	if (lookups) out << " (" << 100.0 * s.m_hits / lookups << "% hit)";
+	out << "\nevictions: " << s.m_evictions << ", not admitted: " << s.m_rejected << '\n'
+		<< "sketch: " << m_sketch.size() << " bytes\n";
+}
+
+std::size_t WordCache::bytes(const WordInfo &info)
+{
+	std::size_t bytes {sizeof(WordInfo) + textBytes(info.lemma) + textBytes(info.etymology)};
+
+	bytes += info.forms.capacity() * sizeof(WordInfo::Form);
+	for (const auto &form : info.forms) bytes += textBytes(form.form) + textBytes(form.tag);
+
+	bytes += info.senses.capacity() * sizeof(WordInfo::Sense);
+	for (const auto &sense : info.senses)
+	{
+		bytes += textBytes(sense.pos) + textBytes(sense.definition);
+		bytes += textBytes(sense.examples) + textBytes(sense.synonyms) + textBytes(sense.antonyms);
+	}
+	return bytes;
+}
+
+/*********************************
+// WordCache Helper Functions
+*********************************/
+void WordCache::record(int word_id)
+{
+	// conservative update: only the smallest counters move, which keeps the estimate tighter
+	std::uint8_t least {frequency(word_id)};
+	if (least < m_maxCount)
+	{
+		for (int row{0}; row < m_rows; ++row)
+		{
+			std::uint8_t &count {m_sketch[slot(word_id, row)]};
+			if (count == least) ++count;
+		}
+	}
+
+	// aging: halve everything now and then, so what was popular long ago fades
+	if (++m_additions >= 10 * m_width)
+	{
+		for (std::uint8_t &count : m_sketch) count >>= 1;
+		m_additions /= 2;
+	}
+}
+
+std::uint8_t WordCache::frequency(int word_id) const
+{
+	std::uint8_t least {m_maxCount};
+	for (int row{0}; row < m_rows; ++row) least = std::min(least, m_sketch[slot(word_id, row)]);
+	return least;
+}
+
+std::size_t WordCache::slot(int word_id, int row) const
+{
+	// splitmix64 finalizer, seeded per row
+	std::uint64_t x {static_cast<std::uint64_t>(static_cast<std::uint32_t>(word_id)) + (row + 1) * 0x9e3779b97f4a7c15ull};
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+	x ^= x >> 31;
+	return row * m_width + (x & (m_width - 1));
+}
+
+void WordCache::evictLast()
+{
+	Entry &last {m_lru.back()};
+	m_bytes -= last.m_bytes;
+	m_index.erase(last.m_wordID);
+	m_lru.pop_back();
+	++m_stats.m_evictions;
+}